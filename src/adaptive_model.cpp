@@ -0,0 +1,85 @@
+#include "adaptive_model.hpp"
+#include <cstring>
+
+AdaptiveContextModel::AdaptiveContextModel()
+    : freq(nullptr), tree(nullptr), totals(nullptr), initialized(nullptr) {}
+
+void AdaptiveContextModel::reset(ScratchArena& arena) {
+    freq = arena.allocateArray<uint32_t>(SYMBOLS * SYMBOLS);
+    tree = arena.allocateArray<uint32_t>(SYMBOLS * (SYMBOLS + 1));
+    totals = arena.allocateArray<uint32_t>(SYMBOLS);
+    initialized = arena.allocateArray<uint8_t>(SYMBOLS);
+    std::memset(initialized, 0, SYMBOLS);
+}
+
+void AdaptiveContextModel::prepare(unsigned char context) {
+    if (initialized[context]) return;
+    uint32_t* f = &freq[context * SYMBOLS];
+    for (uint32_t s = 0; s < SYMBOLS; ++s) {
+        f[s] = 1;
+    }
+    rebuildContext(context);
+    initialized[context] = 1;
+}
+
+void AdaptiveContextModel::rebuildContext(uint32_t context) {
+    uint32_t* t = &tree[context * (SYMBOLS + 1)];
+    const uint32_t* f = &freq[context * SYMBOLS];
+    uint32_t sum = 0;
+    t[0] = 0;
+    for (uint32_t i = 1; i <= SYMBOLS; ++i) {
+        t[i] = f[i - 1];
+        sum += f[i - 1];
+    }
+    for (uint32_t i = 1; i <= SYMBOLS; ++i) {
+        uint32_t parent = i + (i & (0u - i));
+        if (parent <= SYMBOLS) t[parent] += t[i];
+    }
+    totals[context] = sum;
+}
+
+uint32_t AdaptiveContextModel::cumulative(unsigned char context, unsigned char symbol) const {
+    const uint32_t* t = &tree[context * (SYMBOLS + 1)];
+    uint32_t sum = 0;
+    for (uint32_t i = symbol; i > 0; i -= i & (0u - i)) {
+        sum += t[i];
+    }
+    return sum;
+}
+
+uint32_t AdaptiveContextModel::frequency(unsigned char context, unsigned char symbol) const {
+    return freq[context * SYMBOLS + symbol];
+}
+
+uint32_t AdaptiveContextModel::total(unsigned char context) const {
+    return totals[context];
+}
+
+unsigned char AdaptiveContextModel::findSymbol(unsigned char context, uint32_t target) const {
+    const uint32_t* t = &tree[context * (SYMBOLS + 1)];
+    uint32_t pos = 0;
+    for (uint32_t step = SYMBOLS; step > 0; step >>= 1) {
+        if (pos + step <= SYMBOLS && t[pos + step] <= target) {
+            pos += step;
+            target -= t[pos];
+        }
+    }
+    return static_cast<unsigned char>(pos);
+}
+
+void AdaptiveContextModel::update(unsigned char context, unsigned char symbol) {
+    uint32_t* t = &tree[context * (SYMBOLS + 1)];
+    freq[context * SYMBOLS + symbol] += INCREMENT;
+    for (uint32_t i = (uint32_t)symbol + 1; i <= SYMBOLS; i += i & (0u - i)) {
+        t[i] += INCREMENT;
+    }
+    totals[context] += INCREMENT;
+
+    if (totals[context] > MAX_TOTAL) {
+        uint32_t* f = &freq[context * SYMBOLS];
+        for (uint32_t s = 0; s < SYMBOLS; ++s) {
+            f[s] = (f[s] + 1) / 2;
+        }
+        rebuildContext(context);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef ADAPTIVE_MODEL_HPP
+#define ADAPTIVE_MODEL_HPP
+
+#include <cstdint>
+#include "scratch_arena.hpp"
+
+// Order-1 adaptive byte model: one frequency table per previous byte, kept as
+// Fenwick trees so cumulative lookups and symbol search are O(log 256).
+// Tables live in the caller's scratch arena and each context is initialized
+// on first use, so a reset costs one 256-byte clear.
+class AdaptiveContextModel {
+private:
+    static const uint32_t SYMBOLS = 256;
+    static const uint32_t INCREMENT = 32;
+    static const uint32_t MAX_TOTAL = (uint32_t)1 << 16;
+
+    uint32_t* freq;
+    uint32_t* tree;
+    uint32_t* totals;
+    uint8_t* initialized;
+
+    void rebuildContext(uint32_t context);
+
+public:
+    AdaptiveContextModel();
+    void reset(ScratchArena& arena);
+
+    // Must be called before querying a context in the current run.
+    void prepare(unsigned char context);
+    uint32_t cumulative(unsigned char context, unsigned char symbol) const;
+    uint32_t frequency(unsigned char context, unsigned char symbol) const;
+    uint32_t total(unsigned char context) const;
+    unsigned char findSymbol(unsigned char context, uint32_t target) const;
+    void update(unsigned char context, unsigned char symbol);
+};
+
+#endif
@@ -0,0 +1,434 @@
+#include "archive.hpp"
+#include "arithmetic_coder.hpp"
+#include "constants.hpp"
+#include "utils.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint64_t ARCHIVE_HEADER_SIZE = 64;
+const uint64_t ARCHIVE_ENTRY_SIZE = 32;
+const uint64_t ARCHIVE_MODEL_SIZE = 256 * sizeof(uint32_t);
+
+struct ArchiveEntry {
+    uint64_t data_offset;
+    uint64_t data_size;
+    uint64_t original_size;
+    uint32_t name_offset;
+    uint32_t name_length;
+};
+
+uint64_t hashName(const std::string& name) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : name) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint32_t slotCountFor(uint32_t member_count) {
+    uint32_t slots = 1;
+    while (slots < 2 * (uint64_t)member_count) slots <<= 1;
+    return slots;
+}
+
+template <typename T>
+void writeValue(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T loadValue(const uint8_t* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+std::string baseName(const std::string& path) {
+    return path.substr(path.find_last_of("/\\") + 1);
+}
+
+// Member names are joined onto the extraction directory, so they must be a
+// single plain path component.
+bool isSafeMemberName(const std::string& name) {
+    return !name.empty() && name != "." && name.find("..") == std::string::npos &&
+           name.find_first_of(std::string("/\\\0", 3)) == std::string::npos;
+}
+
+}
+
+ArchiveWriter::ArchiveWriter() {}
+
+bool ArchiveWriter::buildSharedModel(const std::vector<std::string>& contents, std::map<unsigned char, uint32_t>& frequency) {
+    uint64_t counts[256] = {0};
+    uint64_t total = 0;
+    for (const auto& member : contents) {
+        for (unsigned char c : member) counts[c]++;
+        total += member.size();
+    }
+    if (total == 0) {
+        return false;
+    }
+
+    // Keep the summed frequencies within what the coder can represent; every
+    // byte that occurs anywhere must keep a non-zero count.
+    const uint64_t limit = MAX_FREQ_SUM - 256;
+    frequency.clear();
+    for (int b = 0; b < 256; ++b) {
+        if (counts[b] == 0) continue;
+        uint64_t freq = total > limit ? (counts[b] * limit) / total : counts[b];
+        frequency[(unsigned char)b] = (uint32_t)(freq == 0 ? 1 : freq);
+    }
+    return true;
+}
+
+bool ArchiveWriter::create(const std::string& archive_filename, const std::vector<std::string>& member_files, bool shared_model) {
+    std::vector<std::string> names;
+    std::vector<std::string> contents(member_files.size());
+    for (size_t i = 0; i < member_files.size(); ++i) {
+        if (!readFileContents(member_files[i], contents[i])) {
+            std::cerr << "Error opening input file: " << member_files[i] << std::endl;
+            return false;
+        }
+        names.push_back(baseName(member_files[i]));
+        if (!isSafeMemberName(names.back())) {
+            std::cerr << "Error: Unsupported archive member name: " << names.back() << std::endl;
+            return false;
+        }
+    }
+
+    uint32_t member_count = (uint32_t)names.size();
+    uint32_t slot_count = slotCountFor(member_count);
+    std::vector<uint32_t> slots(slot_count, 0);
+    std::string name_table;
+    std::vector<ArchiveEntry> entries(member_count);
+
+    for (uint32_t i = 0; i < member_count; ++i) {
+        uint32_t slot = (uint32_t)(hashName(names[i]) & (slot_count - 1));
+        while (slots[slot] != 0) {
+            if (names[slots[slot] - 1] == names[i]) {
+                std::cerr << "Error: Duplicate member name in archive: " << names[i] << std::endl;
+                return false;
+            }
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slots[slot] = i + 1;
+        entries[i].name_offset = (uint32_t)name_table.size();
+        entries[i].name_length = (uint32_t)names[i].size();
+        name_table += names[i];
+    }
+
+    std::map<unsigned char, uint32_t> model;
+    if (shared_model && !buildSharedModel(contents, model)) {
+        shared_model = false;
+    }
+
+    std::ofstream outfile(archive_filename, std::ios::binary);
+    if (!outfile.is_open()) {
+        std::cerr << "Error opening output file: " << archive_filename << std::endl;
+        return false;
+    }
+
+    std::string placeholder(ARCHIVE_HEADER_SIZE, '\0');
+    outfile.write(placeholder.data(), placeholder.size());
+
+    uint64_t model_offset = 0;
+    if (shared_model) {
+        model_offset = (uint64_t)outfile.tellp();
+        for (int b = 0; b < 256; ++b) {
+            auto it = model.find((unsigned char)b);
+            writeValue<uint32_t>(outfile, it == model.end() ? 0 : it->second);
+        }
+    }
+
+    ArithmeticEncoder encoder;
+    for (uint32_t i = 0; i < member_count; ++i) {
+        entries[i].data_offset = (uint64_t)outfile.tellp();
+        entries[i].original_size = contents[i].size();
+
+        std::istringstream member_stream(contents[i]);
+        bool encoded = shared_model ? encoder.encodeWithModel(member_stream, outfile, model)
+                                    : encoder.encodeStream(member_stream, outfile);
+        if (!encoded) {
+            std::cerr << "Error encoding archive member: " << names[i] << std::endl;
+            outfile.close();
+            std::remove(archive_filename.c_str());
+            return false;
+        }
+        entries[i].data_size = (uint64_t)outfile.tellp() - entries[i].data_offset;
+    }
+
+    uint64_t entries_offset = (uint64_t)outfile.tellp();
+    for (const auto& entry : entries) {
+        writeValue(outfile, entry.data_offset);
+        writeValue(outfile, entry.data_size);
+        writeValue(outfile, entry.original_size);
+        writeValue(outfile, entry.name_offset);
+        writeValue(outfile, entry.name_length);
+    }
+    uint64_t slots_offset = (uint64_t)outfile.tellp();
+    for (uint32_t slot : slots) {
+        writeValue(outfile, slot);
+    }
+    uint64_t names_offset = (uint64_t)outfile.tellp();
+    outfile.write(name_table.data(), name_table.size());
+
+    outfile.seekp(0);
+    outfile.write(ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    writeValue(outfile, ARCHIVE_VERSION);
+    writeValue<uint32_t>(outfile, shared_model ? ARCHIVE_FLAG_SHARED_MODEL : 0);
+    writeValue(outfile, member_count);
+    writeValue(outfile, slot_count);
+    writeValue<uint32_t>(outfile, 0);
+    writeValue(outfile, model_offset);
+    writeValue(outfile, entries_offset);
+    writeValue(outfile, slots_offset);
+    writeValue(outfile, names_offset);
+    writeValue<uint64_t>(outfile, name_table.size());
+
+    outfile.close();
+    if (!outfile) {
+        std::cerr << "Error occurred during final write/close of file: " << archive_filename << std::endl;
+        std::remove(archive_filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+ArchiveReader::ArchiveReader()
+    : data(nullptr), size(0), mapping(nullptr), member_count(0), slot_count(0), flags(0),
+      entries_offset(0), slots_offset(0), names_offset(0), names_size(0) {}
+
+ArchiveReader::~ArchiveReader() {
+    close();
+}
+
+void ArchiveReader::close() {
+#ifndef _WIN32
+    if (mapping) {
+        ::munmap(mapping, (size_t)size);
+    }
+#endif
+    mapping = nullptr;
+    fallback_buffer.clear();
+    data = nullptr;
+    size = 0;
+    member_count = 0;
+    shared_model.clear();
+}
+
+bool ArchiveReader::mapFile(const std::string& filename) {
+#ifdef _WIN32
+    if (!readFileContents(filename, fallback_buffer)) {
+        std::cerr << "Error opening input file: " << filename << std::endl;
+        return false;
+    }
+    data = reinterpret_cast<const uint8_t*>(fallback_buffer.data());
+    size = fallback_buffer.size();
+    return true;
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error opening input file: " << filename << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || (uint64_t)st.st_size < ARCHIVE_HEADER_SIZE) {
+        std::cerr << "Error: " << filename << " is too small to be an archive." << std::endl;
+        ::close(fd);
+        return false;
+    }
+    void* p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "Error mapping archive: " << filename << std::endl;
+        return false;
+    }
+    mapping = p;
+    data = static_cast<const uint8_t*>(p);
+    size = (uint64_t)st.st_size;
+    return true;
+#endif
+}
+
+bool ArchiveReader::validateDirectory() {
+    if (size < ARCHIVE_HEADER_SIZE || std::memcmp(data, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0) {
+        std::cerr << "Error: Missing archive magic." << std::endl;
+        return false;
+    }
+    uint32_t version = loadValue<uint32_t>(data + 4);
+    if (version != ARCHIVE_VERSION) {
+        std::cerr << "Error: Unsupported archive version " << version << "." << std::endl;
+        return false;
+    }
+    flags = loadValue<uint32_t>(data + 8);
+    member_count = loadValue<uint32_t>(data + 12);
+    slot_count = loadValue<uint32_t>(data + 16);
+    uint64_t model_offset = loadValue<uint64_t>(data + 24);
+    entries_offset = loadValue<uint64_t>(data + 32);
+    slots_offset = loadValue<uint64_t>(data + 40);
+    names_offset = loadValue<uint64_t>(data + 48);
+    names_size = loadValue<uint64_t>(data + 56);
+
+    if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0 || slot_count < member_count ||
+        entries_offset > size || (uint64_t)member_count * ARCHIVE_ENTRY_SIZE > size - entries_offset ||
+        slots_offset > size || (uint64_t)slot_count * sizeof(uint32_t) > size - slots_offset ||
+        names_offset > size || names_size > size - names_offset) {
+        std::cerr << "Error: Archive directory is out of bounds." << std::endl;
+        return false;
+    }
+
+    if (flags & ARCHIVE_FLAG_SHARED_MODEL) {
+        if (model_offset > size || ARCHIVE_MODEL_SIZE > size - model_offset) {
+            std::cerr << "Error: Archive shared model is out of bounds." << std::endl;
+            return false;
+        }
+        for (int b = 0; b < 256; ++b) {
+            uint32_t freq = loadValue<uint32_t>(data + model_offset + b * sizeof(uint32_t));
+            if (freq != 0) shared_model[(unsigned char)b] = freq;
+        }
+    }
+    // Entries are checked by getMemberInfo when used, so opening stays O(1).
+    return true;
+}
+
+bool ArchiveReader::open(const std::string& archive_filename) {
+    close();
+    if (!mapFile(archive_filename)) {
+        return false;
+    }
+    if (!validateDirectory()) {
+        std::cerr << "Failed to read or validate archive: " << archive_filename << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+uint32_t ArchiveReader::getMemberCount() const {
+    return member_count;
+}
+
+bool ArchiveReader::hasSharedModel() const {
+    return (flags & ARCHIVE_FLAG_SHARED_MODEL) != 0;
+}
+
+bool ArchiveReader::getMemberInfo(uint32_t index, ArchiveMemberInfo& info) const {
+    if (index >= member_count) return false;
+    const uint8_t* entry = data + entries_offset + (uint64_t)index * ARCHIVE_ENTRY_SIZE;
+    info.data_offset = loadValue<uint64_t>(entry);
+    info.data_size = loadValue<uint64_t>(entry + 8);
+    info.original_size = loadValue<uint64_t>(entry + 16);
+    uint32_t name_offset = loadValue<uint32_t>(entry + 24);
+    uint32_t name_length = loadValue<uint32_t>(entry + 28);
+
+    if (info.data_offset > size || info.data_size > size - info.data_offset ||
+        name_offset > names_size || name_length > names_size - name_offset) {
+        return false;
+    }
+    info.name.assign(reinterpret_cast<const char*>(data + names_offset + name_offset), name_length);
+    return isSafeMemberName(info.name);
+}
+
+int64_t ArchiveReader::findMember(const std::string& name) const {
+    if (member_count == 0) return -1;
+    const uint8_t* slots = data + slots_offset;
+    uint32_t slot = (uint32_t)(hashName(name) & (slot_count - 1));
+    for (uint32_t probes = 0; probes < slot_count; ++probes) {
+        uint32_t value = loadValue<uint32_t>(slots + (uint64_t)slot * sizeof(uint32_t));
+        if (value == 0 || value > member_count) return -1;
+
+        const uint8_t* entry = data + entries_offset + (uint64_t)(value - 1) * ARCHIVE_ENTRY_SIZE;
+        uint32_t name_offset = loadValue<uint32_t>(entry + 24);
+        uint32_t name_length = loadValue<uint32_t>(entry + 28);
+        if (name_offset > names_size || name_length > names_size - name_offset) return -1;
+        if (name_length == name.size() &&
+            std::memcmp(data + names_offset + name_offset, name.data(), name_length) == 0) {
+            return value - 1;
+        }
+        slot = (slot + 1) & (slot_count - 1);
+    }
+    return -1;
+}
+
+bool ArchiveReader::extractMember(uint32_t index, const std::string& output_filename, ArithmeticDecoder& decoder) const {
+    ArchiveMemberInfo info;
+    if (!getMemberInfo(index, info)) {
+        std::cerr << "Error: Invalid archive member index " << index << "." << std::endl;
+        return false;
+    }
+
+    std::ofstream outfile(output_filename, std::ios::binary);
+    if (!outfile.is_open()) {
+        std::cerr << "Error opening output file: " << output_filename << std::endl;
+        return false;
+    }
+
+    // Members are decoded straight from the mapped archive, without a copy.
+    const uint8_t* member = data + info.data_offset;
+    bool decoded = hasSharedModel()
+        ? decoder.decodeWithModelBuffer(member, (size_t)info.data_size, info.original_size, shared_model)
+        : decoder.decodeBuffer(member, (size_t)info.data_size);
+    const std::vector<uint8_t>& output = decoder.getOutput();
+    if (decoded && !output.empty()) {
+        outfile.write(reinterpret_cast<const char*>(output.data()), output.size());
+    }
+
+    outfile.close();
+    if (!decoded || !outfile) {
+        std::cerr << "Error extracting archive member: " << info.name << std::endl;
+        std::remove(output_filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ArchiveReader::extractMembers(const std::vector<uint32_t>& requested, const std::string& output_dir, unsigned thread_count) const {
+    // A member named twice would have two threads writing the same file.
+    std::vector<uint32_t> indices(requested);
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    if (thread_count == 0) thread_count = 1;
+    if (thread_count > indices.size()) thread_count = (unsigned)indices.size();
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> all_successful(true);
+    auto worker = [&]() {
+        ArithmeticDecoder decoder;
+        for (size_t i = next++; i < indices.size(); i = next++) {
+            ArchiveMemberInfo info;
+            if (!getMemberInfo(indices[i], info)) {
+                std::cerr << "Error: Archive entry " << indices[i] << " is out of bounds or has an invalid name." << std::endl;
+                all_successful = false;
+            } else if (!extractMember(indices[i], output_dir + "/" + info.name, decoder)) {
+                all_successful = false;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < thread_count; ++t) {
+        workers.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto& t : workers) {
+        t.join();
+    }
+    return all_successful;
+}
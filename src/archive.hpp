@@ -0,0 +1,72 @@
+#ifndef ARCHIVE_HPP
+#define ARCHIVE_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+class ArithmeticDecoder;
+
+// Archive layout (all integers native-endian, like the codestream header):
+//   header (64 bytes) | [shared model: 256 x uint32] | member data ...
+//   | entries (32 bytes each) | hash slots (uint32 each) | name table
+// The header carries the directory offsets, so a reader can map the file and
+// resolve one member by hashing its name without touching any member data.
+// Members are full codestreams, or bare coded payloads when the shared model is used.
+
+struct ArchiveMemberInfo {
+    std::string name;
+    uint64_t data_offset;
+    uint64_t data_size;
+    uint64_t original_size;
+
+    ArchiveMemberInfo() : data_offset(0), data_size(0), original_size(0) {}
+};
+
+class ArchiveWriter {
+private:
+    bool buildSharedModel(const std::vector<std::string>& contents, std::map<unsigned char, uint32_t>& frequency);
+
+public:
+    ArchiveWriter();
+    bool create(const std::string& archive_filename, const std::vector<std::string>& member_files, bool shared_model);
+};
+
+class ArchiveReader {
+private:
+    const uint8_t* data;
+    uint64_t size;
+    void* mapping;
+    std::string fallback_buffer;
+
+    uint32_t member_count;
+    uint32_t slot_count;
+    uint32_t flags;
+    uint64_t entries_offset;
+    uint64_t slots_offset;
+    uint64_t names_offset;
+    uint64_t names_size;
+    std::map<unsigned char, uint32_t> shared_model;
+
+    bool mapFile(const std::string& filename);
+    bool validateDirectory();
+
+public:
+    ArchiveReader();
+    ~ArchiveReader();
+
+    bool open(const std::string& archive_filename);
+    void close();
+
+    uint32_t getMemberCount() const;
+    bool hasSharedModel() const;
+    bool getMemberInfo(uint32_t index, ArchiveMemberInfo& info) const;
+    // Returns the member index, or -1 if no member has that name.
+    int64_t findMember(const std::string& name) const;
+    // The decoder's buffers are reused, so pass the same one for many members.
+    bool extractMember(uint32_t index, const std::string& output_filename, ArithmeticDecoder& decoder) const;
+    bool extractMembers(const std::vector<uint32_t>& indices, const std::string& output_dir, unsigned thread_count) const;
+};
+
+#endif
@@ -3,10 +3,58 @@
 #include <iostream>
 #include <fstream>
 #include <limits>
-#include <stdexcept>
+#include <cstring>
+#include <cstdio>
 
-ArithmeticEncoder::ArithmeticEncoder() 
-    : low(0), high(TOP_VALUE), bits_to_follow(0), bit_io(nullptr), total_byte_count(0) {}
+namespace {
+
+const size_t READ_CHUNK_SIZE = 1 << 16;
+
+// Reads the rest of `in` into `buffer`, reusing whatever capacity it already has.
+bool readAll(std::istream& in, std::vector<uint8_t>& buffer) {
+    size_t size = 0;
+    for (;;) {
+        if (buffer.size() < size + READ_CHUNK_SIZE) {
+            buffer.resize(size + READ_CHUNK_SIZE);
+        }
+        in.read(reinterpret_cast<char*>(buffer.data() + size), READ_CHUNK_SIZE);
+        size += static_cast<size_t>(in.gcount());
+        if (!in) break;
+    }
+    bool ok = !in.bad();
+    buffer.resize(size);
+    in.clear();
+    return ok;
+}
+
+bool writeAll(std::ostream& out, const std::vector<uint8_t>& buffer) {
+    if (!buffer.empty()) {
+        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    }
+    return out.good();
+}
+
+template <typename T>
+void appendValue(std::vector<uint8_t>& buffer, T value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+}
+
+template <typename T>
+bool loadValue(const uint8_t* data, size_t size, size_t& pos, T& value) {
+    if (size - pos < sizeof(value)) return false;
+    std::memcpy(&value, data + pos, sizeof(value));
+    pos += sizeof(value);
+    return true;
+}
+
+}
+
+ArithmeticEncoder::ArithmeticEncoder()
+    : low(0), high(TOP_VALUE), bits_to_follow(0), bit_io(nullptr), total_byte_count(0) {
+    std::memset(frequency, 0, sizeof(frequency));
+    std::memset(cumulative, 0, sizeof(cumulative));
+}
 
 void ArithmeticEncoder::outputBitPlusFollow(int bit) {
     bit_io->writeBit(bit);
@@ -16,70 +64,63 @@ void ArithmeticEncoder::outputBitPlusFollow(int bit) {
     }
 }
 
-uint64_t ArithmeticEncoder::calculateByteFrequencyTables(std::istream& in,
-                                      std::map<unsigned char, uint32_t>& frequency,
-                                      std::map<unsigned char, uint64_t>& cumulative) {
-    frequency.clear();
-    cumulative.clear();
-    uint64_t current_total_bytes = 0;
-    std::map<unsigned char, uint64_t> freq64;
-
-    char byte_char;
-    while (in.get(byte_char)) {
-        unsigned char byte_val = static_cast<unsigned char>(byte_char);
-        freq64[byte_val]++;
-        current_total_bytes++;
-    }
-    if (!in.eof()) {
-        std::cerr << "Error reading input file during frequency calculation." << std::endl;
-        return 0;
+uint64_t ArithmeticEncoder::calculateByteFrequencyTables(const uint8_t* data, size_t size,
+                                      uint32_t frequency[256],
+                                      uint64_t cumulative[257]) {
+    uint64_t freq64[256] = {0};
+    for (size_t i = 0; i < size; ++i) {
+        freq64[data[i]]++;
     }
-    in.clear();
-    in.seekg(0);
 
-    for(const auto& pair : freq64) {
-        if (pair.second > std::numeric_limits<uint32_t>::max()) {
-            std::cerr << "Error: Frequency count for byte " << (int)pair.first << " exceeds uint32_t limit." << std::endl;
+    uint64_t cum = 0;
+    for (int byte_val = 0; byte_val < 256; ++byte_val) {
+        if (freq64[byte_val] > std::numeric_limits<uint32_t>::max()) {
+            std::cerr << "Error: Frequency count for byte " << byte_val << " exceeds uint32_t limit." << std::endl;
             return 0;
         }
-        frequency[pair.first] = static_cast<uint32_t>(pair.second);
-    }
-
-    uint64_t cum = 0;
-    for (auto const& pair : frequency) {
-        unsigned char byte_val = pair.first;
-        uint32_t freq = pair.second;
-        if (freq == 0) continue;
+        frequency[byte_val] = static_cast<uint32_t>(freq64[byte_val]);
         cumulative[byte_val] = cum;
-        cum += freq;
+        cum += freq64[byte_val];
     }
+    cumulative[256] = cum;
 
-    if (cum != current_total_bytes) {
-        std::cerr << "Internal Error: Cumulative frequency calculation mismatch (" << cum << " != " << current_total_bytes << ")" << std::endl;
+    if (cum != size) {
+        std::cerr << "Internal Error: Cumulative frequency calculation mismatch (" << cum << " != " << size << ")" << std::endl;
         return 0;
     }
 
-    return current_total_bytes;
+    return cum;
 }
 
-bool ArithmeticEncoder::writeHeader(std::ostream& out,
-                   uint64_t total_bytes,
-                   const std::map<unsigned char, uint32_t>& frequency) {
+void ArithmeticEncoder::writeHeader(uint64_t total_bytes) {
+    appendValue(output_buffer, total_bytes);
 
-    out.write(reinterpret_cast<const char*>(&total_bytes), sizeof(total_bytes));
+    uint32_t num_symbols = 0;
+    for (int byte_val = 0; byte_val < 256; ++byte_val) {
+        if (frequency[byte_val] != 0) num_symbols++;
+    }
+    appendValue(output_buffer, num_symbols);
 
-    uint32_t num_symbols = frequency.size();
-    out.write(reinterpret_cast<const char*>(&num_symbols), sizeof(num_symbols));
+    for (int byte_val = 0; byte_val < 256; ++byte_val) {
+        if (frequency[byte_val] == 0) continue;
+        appendValue(output_buffer, static_cast<unsigned char>(byte_val));
+        appendValue(output_buffer, frequency[byte_val]);
+    }
+}
 
-    for (auto const& pair : frequency) {
-        unsigned char byte_val = pair.first;
-        uint32_t freq = pair.second;
-        out.write(reinterpret_cast<const char*>(&byte_val), sizeof(byte_val));
-        out.write(reinterpret_cast<const char*>(&freq), sizeof(freq));
+uint64_t ArithmeticEncoder::loadModel(const std::map<unsigned char, uint32_t>& model) {
+    std::memset(frequency, 0, sizeof(frequency));
+    for (auto const& pair : model) {
+        frequency[pair.first] = pair.second;
     }
 
-    out << std::flush;
-    return out.good();
+    uint64_t cum = 0;
+    for (int byte_val = 0; byte_val < 256; ++byte_val) {
+        cumulative[byte_val] = cum;
+        cum += frequency[byte_val];
+    }
+    cumulative[256] = cum;
+    return cum;
 }
 
 bool ArithmeticEncoder::encode(const std::string& input_filename, const std::string& output_filename) {
@@ -96,97 +137,187 @@ bool ArithmeticEncoder::encode(const std::string& input_filename, const std::str
         return false;
     }
 
-    std::map<unsigned char, uint32_t> frequency;
-    std::map<unsigned char, uint64_t> cumulative_frequency;
-    total_byte_count = calculateByteFrequencyTables(infile, frequency, cumulative_frequency);
-
-    if (total_byte_count == 0 && !frequency.empty()) {
+    if (!encodeStream(infile, outfile)) {
         infile.close();
         outfile.close();
         std::remove(output_filename.c_str());
         return false;
     }
 
-    if (total_byte_count == 0 && frequency.empty()) {
+    infile.close();
+    outfile.close();
+    if (!outfile) {
+        std::cerr << "Error occurred during final write/close of file: " << output_filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ArithmeticEncoder::encodeStream(std::istream& in, std::ostream& out) {
+    if (!readAll(in, input_buffer)) {
+        std::cerr << "Error reading input file during frequency calculation." << std::endl;
+        return false;
+    }
+
+    if (!encodeBuffer(input_buffer.data(), input_buffer.size())) {
+        return false;
+    }
+    if (!writeAll(out, output_buffer)) {
+        std::cerr << "Error writing codestream to output stream." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ArithmeticEncoder::encodeBuffer(const uint8_t* data, size_t size) {
+    output_buffer.clear();
+    total_byte_count = calculateByteFrequencyTables(data, size, frequency, cumulative);
+
+    if (size == 0) {
         std::cout << "Input file is empty. Writing minimal header." << std::endl;
-        writeHeader(outfile, 0, frequency);
-        infile.close();
-        outfile.close();
+        writeHeader(0);
         return true;
     }
 
+    if (total_byte_count == 0) {
+        return false;
+    }
+
     if (total_byte_count > MAX_FREQ_SUM) {
         std::cerr << "Error: Total byte count (" << total_byte_count
                   << ") exceeds maximum allowed (" << MAX_FREQ_SUM
                   << "). Cannot encode reliably." << std::endl;
-        infile.close();
-        outfile.close();
-        std::remove(output_filename.c_str());
         return false;
     }
 
-    if (!writeHeader(outfile, total_byte_count, frequency)) {
-        std::cerr << "Error writing header to output file: " << output_filename << std::endl;
-        infile.close();
-        outfile.close();
-        std::remove(output_filename.c_str());
+    writeHeader(total_byte_count);
+    return encodeSymbols(data, size, total_byte_count);
+}
+
+bool ArithmeticEncoder::encodeWithModel(std::istream& in, std::ostream& out,
+                                        const std::map<unsigned char, uint32_t>& model) {
+    uint64_t freq_total = loadModel(model);
+
+    if (freq_total == 0 || freq_total > MAX_FREQ_SUM) {
+        std::cerr << "Error: Model frequency sum (" << freq_total
+                  << ") must be between 1 and " << MAX_FREQ_SUM << "." << std::endl;
         return false;
     }
 
-    BitIO bit_io_obj(&outfile);
+    if (!readAll(in, input_buffer)) {
+        std::cerr << "Error reading input stream." << std::endl;
+        return false;
+    }
+
+    output_buffer.clear();
+    if (input_buffer.empty()) {
+        return true;
+    }
+
+    return encodeSymbols(input_buffer.data(), input_buffer.size(), freq_total) &&
+           writeAll(out, output_buffer);
+}
+
+bool ArithmeticEncoder::encodeSymbols(const uint8_t* data, size_t size, uint64_t freq_total) {
+    BitIO bit_io_obj(&output_buffer);
     bit_io = &bit_io_obj;
 
     low = 0;
     high = TOP_VALUE;
     bits_to_follow = 0;
 
-    char byte_char;
-    while (infile.get(byte_char)) {
-        unsigned char byte_val = static_cast<unsigned char>(byte_char);
-
-        uint64_t range = (uint64_t)high - low + 1;
-
-        auto freq_it = frequency.find(byte_val);
-        auto cum_freq_it = cumulative_frequency.find(byte_val);
-        if (freq_it == frequency.end() || cum_freq_it == cumulative_frequency.end()) {
-            std::cerr << "Internal Error: Byte " << (int)byte_val << " not found in frequency tables during encoding pass 2." << std::endl;
-            infile.close();
-            outfile.close();
-            std::remove(output_filename.c_str());
+    for (size_t i = 0; i < size; ++i) {
+        unsigned char byte_val = data[i];
+        if (frequency[byte_val] == 0) {
+            std::cerr << "Error: Byte " << (int)byte_val << " not found in frequency tables during encoding." << std::endl;
+            bit_io = nullptr;
             return false;
         }
-        uint32_t sym_freq = freq_it->second;
-        uint64_t sym_cum_freq = cum_freq_it->second;
-
-        high = low + (uint32_t)((range * (sym_cum_freq + sym_freq)) / total_byte_count) - 1;
-        low = low + (uint32_t)((range * sym_cum_freq) / total_byte_count);
-
-        for (;;) {
-            if (high < HALF) {
-                outputBitPlusFollow(0);
-            } else if (low >= HALF) {
-                outputBitPlusFollow(1);
-                low -= HALF;
-                high -= HALF;
-            } else if (low >= FIRST_QTR && high < THIRD_QTR) {
-                bits_to_follow++;
-                low -= FIRST_QTR;
-                high -= FIRST_QTR;
-            } else {
-                break;
-            }
-            low <<= 1;
-            high = (high << 1) + 1;
-        }
+        encodeInterval(cumulative[byte_val], frequency[byte_val], freq_total);
     }
-    if (!infile.eof()) {
-        std::cerr << "Error reading input file during encoding pass 2." << std::endl;
-        infile.close();
-        outfile.close();
-        std::remove(output_filename.c_str());
+
+    finishEncoding();
+    return true;
+}
+
+bool ArithmeticEncoder::encodeAdaptive(std::istream& in, std::ostream& out) {
+    if (!readAll(in, input_buffer)) {
+        std::cerr << "Error reading input stream for adaptive encoding." << std::endl;
+        return false;
+    }
+
+    return encodeAdaptiveBuffer(input_buffer.data(), input_buffer.size()) &&
+           writeAll(out, output_buffer);
+}
+
+bool ArithmeticEncoder::encodeAdaptiveBuffer(const uint8_t* data, size_t size) {
+    output_buffer.clear();
+
+    uint64_t total_bytes = size;
+    if (total_bytes > MAX_FREQ_SUM) {
+        std::cerr << "Error: Total byte count (" << total_bytes
+                  << ") exceeds maximum allowed (" << MAX_FREQ_SUM
+                  << "). Cannot encode reliably." << std::endl;
         return false;
     }
+    appendValue(output_buffer, total_bytes);
+    if (total_bytes == 0) {
+        return true;
+    }
+
+    scratch.reset();
+    adaptive_model.reset(scratch);
+    BitIO bit_io_obj(&output_buffer);
+    bit_io = &bit_io_obj;
+
+    low = 0;
+    high = TOP_VALUE;
+    bits_to_follow = 0;
+
+    unsigned char context = 0;
+    for (size_t i = 0; i < size; ++i) {
+        unsigned char byte_val = data[i];
+        adaptive_model.prepare(context);
+        encodeInterval(adaptive_model.cumulative(context, byte_val), adaptive_model.frequency(context, byte_val),
+                       adaptive_model.total(context));
+        adaptive_model.update(context, byte_val);
+        context = byte_val;
+    }
+
+    finishEncoding();
+    return true;
+}
+
+const std::vector<uint8_t>& ArithmeticEncoder::getOutput() const {
+    return output_buffer;
+}
+
+void ArithmeticEncoder::encodeInterval(uint64_t cum_freq, uint32_t freq, uint64_t freq_total) {
+    uint64_t range = (uint64_t)high - low + 1;
+
+    high = low + (uint32_t)((range * (cum_freq + freq)) / freq_total) - 1;
+    low = low + (uint32_t)((range * cum_freq) / freq_total);
+
+    for (;;) {
+        if (high < HALF) {
+            outputBitPlusFollow(0);
+        } else if (low >= HALF) {
+            outputBitPlusFollow(1);
+            low -= HALF;
+            high -= HALF;
+        } else if (low >= FIRST_QTR && high < THIRD_QTR) {
+            bits_to_follow++;
+            low -= FIRST_QTR;
+            high -= FIRST_QTR;
+        } else {
+            break;
+        }
+        low <<= 1;
+        high = (high << 1) + 1;
+    }
+}
 
+void ArithmeticEncoder::finishEncoding() {
     bits_to_follow++;
     if (low < FIRST_QTR) {
         outputBitPlusFollow(0);
@@ -194,40 +325,32 @@ bool ArithmeticEncoder::encode(const std::string& input_filename, const std::str
         outputBitPlusFollow(1);
     }
     bit_io->flush();
-
-    infile.close();
-    outfile.close();
-    if (!outfile) {
-        std::cerr << "Error occurred during final write/close of file: " << output_filename << std::endl;
-        return false;
-    }
-    return true;
+    bit_io = nullptr;
 }
 
-ArithmeticDecoder::ArithmeticDecoder() 
-    : low(0), high(TOP_VALUE), value(0), bit_io(nullptr), total_freq_sum(0) {}
+ArithmeticDecoder::ArithmeticDecoder()
+    : low(0), high(TOP_VALUE), value(0), bit_io(nullptr), total_freq_sum(0), active_count(0) {
+    std::memset(frequency, 0, sizeof(frequency));
+    std::memset(cumulative, 0, sizeof(cumulative));
+}
 
 int ArithmeticDecoder::inputBit() {
     return bit_io->readBit();
 }
 
-bool ArithmeticDecoder::readHeader(std::istream& in,
-                 uint64_t& total_bytes_to_decode,
-                 std::map<unsigned char, uint32_t>& frequency,
-                 std::map<unsigned char, uint64_t>& cumulative,
-                 std::map<uint64_t, unsigned char>& lookup_symbol)
+bool ArithmeticDecoder::readHeader(const uint8_t* data, size_t size, size_t& header_size,
+                                   uint64_t& total_bytes_to_decode)
 {
-    frequency.clear();
-    cumulative.clear();
-    lookup_symbol.clear();
+    std::memset(frequency, 0, sizeof(frequency));
+    size_t pos = 0;
 
-    if (!in.read(reinterpret_cast<char*>(&total_bytes_to_decode), sizeof(total_bytes_to_decode))) {
+    if (!loadValue(data, size, pos, total_bytes_to_decode)) {
         std::cerr << "Error reading total byte count from header." << std::endl;
         return false;
     }
 
     uint32_t num_symbols;
-    if (!in.read(reinterpret_cast<char*>(&num_symbols), sizeof(num_symbols))) {
+    if (!loadValue(data, size, pos, num_symbols)) {
         std::cerr << "Error reading number of symbols from header." << std::endl;
         return false;
     }
@@ -236,8 +359,7 @@ bool ArithmeticDecoder::readHeader(std::istream& in,
     for (uint32_t i = 0; i < num_symbols; ++i) {
         unsigned char byte_val;
         uint32_t freq;
-        if (!in.read(reinterpret_cast<char*>(&byte_val), sizeof(byte_val)) ||
-            !in.read(reinterpret_cast<char*>(&freq), sizeof(freq))) {
+        if (!loadValue(data, size, pos, byte_val) || !loadValue(data, size, pos, freq)) {
             std::cerr << "Error reading frequency table entry " << i << "." << std::endl;
             return false;
         }
@@ -245,66 +367,84 @@ bool ArithmeticDecoder::readHeader(std::istream& in,
             std::cerr << "Warning: Symbol " << (int)byte_val << " has zero frequency in header." << std::endl;
             continue;
         }
+        if (frequency[byte_val] != 0) {
+            std::cerr << "Error: Symbol " << (int)byte_val << " appears more than once in header." << std::endl;
+            return false;
+        }
         frequency[byte_val] = freq;
         current_total_freq += freq;
     }
 
-    if (current_total_freq != total_bytes_to_decode && total_bytes_to_decode != 0) {
-        std::cerr << "Warning: Sum of frequencies from header (" << current_total_freq
+    // The encoder always writes the frequency sum as the byte count, so any
+    // mismatch means a corrupt header; decoding it would run away with memory.
+    if (total_bytes_to_decode > MAX_FREQ_SUM) {
+        std::cerr << "Error: Total byte count (" << total_bytes_to_decode
+                  << ") read from header exceeds maximum allowed (" << MAX_FREQ_SUM << ")." << std::endl;
+        return false;
+    }
+    if (current_total_freq != total_bytes_to_decode) {
+        std::cerr << "Error: Sum of frequencies from header (" << current_total_freq
                   << ") does not match total byte count (" << total_bytes_to_decode << ")." << std::endl;
-        if (current_total_freq == 0) {
-            std::cerr << "Error: Frequency sum is zero but total bytes is non-zero." << std::endl;
-            return false;
-        }
-    } else if (total_bytes_to_decode == 0 && current_total_freq != 0) {
-        std::cerr << "Error: Total bytes is zero but frequency sum is non-zero." << std::endl;
         return false;
     }
 
     total_freq_sum = current_total_freq;
 
-    if (total_freq_sum > MAX_FREQ_SUM && total_freq_sum != 0) {
-        std::cerr << "Error: Total frequency sum (" << total_freq_sum
-                  << ") read from header exceeds maximum allowed (" << MAX_FREQ_SUM
-                  << "). Cannot decode reliably." << std::endl;
-        return false;
-    }
+    header_size = pos;
+    return true;
+}
 
+bool ArithmeticDecoder::buildLookup() {
     uint64_t cum = 0;
-    for (auto const& pair : frequency) {
-        unsigned char byte_val = pair.first;
-        uint32_t freq = pair.second;
+    active_count = 0;
+    for (int byte_val = 0; byte_val < 256; ++byte_val) {
         cumulative[byte_val] = cum;
-        lookup_symbol[cum] = byte_val;
-        cum += freq;
-    }
+        if (frequency[byte_val] == 0) continue;
+        active_symbols[active_count] = static_cast<uint8_t>(byte_val);
+        active_cumulative[active_count] = cum;
+        active_count++;
+        cum += frequency[byte_val];
+    }
+    cumulative[256] = cum;
+    total_freq_sum = cum;
+    return cum != 0;
+}
 
-    return in.good();
+uint64_t ArithmeticDecoder::loadModel(const std::map<unsigned char, uint32_t>& model) {
+    std::memset(frequency, 0, sizeof(frequency));
+    for (auto const& pair : model) {
+        frequency[pair.first] = pair.second;
+    }
+    buildLookup();
+    return total_freq_sum;
 }
 
-unsigned char ArithmeticDecoder::findSymbol(uint64_t scaled_value, const std::map<uint64_t, unsigned char>& lookup_symbol) {
-    auto it = lookup_symbol.upper_bound(scaled_value);
-    if (it == lookup_symbol.begin()) {
-        if (lookup_symbol.empty() || lookup_symbol.begin()->first != 0 || scaled_value != 0) {
-            std::cerr << "Error: Scaled value " << scaled_value << " is below the lowest cumulative frequency." << std::endl;
-            throw std::runtime_error("Symbol lookup failed");
+unsigned char ArithmeticDecoder::findSymbol(uint64_t scaled_value) const {
+    // Last present symbol whose cumulative frequency does not exceed scaled_value.
+    uint32_t lo = 0;
+    uint32_t hi = active_count;
+    while (hi - lo > 1) {
+        uint32_t mid = (lo + hi) / 2;
+        if (active_cumulative[mid] <= scaled_value) {
+            lo = mid;
+        } else {
+            hi = mid;
         }
-        it = lookup_symbol.begin();
-    } else {
-        --it;
     }
-    return it->second;
+    return active_symbols[lo];
 }
 
 bool ArithmeticDecoder::initializeDecoder() {
     value = 0;
-    for (int i = 0; i < CODE_VALUE_BITS; i++) {
+    // Short payloads end before CODE_VALUE_BITS; the encoder's final bits are
+    // chosen so that zero padding stays inside the last interval.
+    for (uint32_t i = 0; i < CODE_VALUE_BITS; i++) {
         int bit = inputBit();
-        if (bit == -1) {
-            std::cerr << "Error: Premature EOF encountered while initializing decoder value (read " << i << " bits)." << std::endl;
+        if (bit == -1 && i == 0) {
+            std::cerr << "Error: Premature EOF encountered while initializing decoder value (no payload)." << std::endl;
             return false;
         }
-        value = (value << 1) | bit;
+        value = (value << 1) | (bit == -1 ? 0 : bit);
     }
     return true;
 }
@@ -323,96 +463,193 @@ bool ArithmeticDecoder::decode(const std::string& input_filename, const std::str
         return false;
     }
 
-    uint64_t total_bytes_to_decode;
-    std::map<unsigned char, uint32_t> frequency;
-    std::map<unsigned char, uint64_t> cumulative_frequency;
-    std::map<uint64_t, unsigned char> lookup_symbol;
-
-    if (!readHeader(infile, total_bytes_to_decode, frequency,
-                  cumulative_frequency, lookup_symbol)) {
-        std::cerr << "Failed to read or validate header from: " << input_filename << std::endl;
+    if (!decodeStream(infile, outfile)) {
+        std::cerr << "Failed to decode codestream: " << input_filename << std::endl;
         infile.close();
         outfile.close();
         std::remove(output_filename.c_str());
         return false;
     }
 
+    infile.close();
+    outfile.close();
+    if (!outfile) {
+        std::cerr << "Error occurred during final write/close of file: " << output_filename << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool ArithmeticDecoder::decodeStream(std::istream& in, std::ostream& out) {
+    if (!readAll(in, input_buffer)) {
+        std::cerr << "Error reading codestream." << std::endl;
+        return false;
+    }
+
+    return decodeBuffer(input_buffer.data(), input_buffer.size()) &&
+           writeAll(out, output_buffer);
+}
+
+bool ArithmeticDecoder::decodeBuffer(const uint8_t* data, size_t size) {
+    output_buffer.clear();
+
+    size_t header_size = 0;
+    uint64_t total_bytes_to_decode;
+    if (!readHeader(data, size, header_size, total_bytes_to_decode)) {
+        std::cerr << "Failed to read or validate header." << std::endl;
+        return false;
+    }
+
     if (total_bytes_to_decode == 0) {
         std::cout << "Header indicates empty file (0 bytes). Creating empty output file." << std::endl;
-        infile.close();
-        outfile.close();
         return true;
     }
 
-    BitIO bit_io_obj(&infile);
+    if (!buildLookup()) {
+        return false;
+    }
+    return decodeSymbols(data + header_size, size - header_size, total_bytes_to_decode);
+}
+
+bool ArithmeticDecoder::decodeWithModel(std::istream& in, std::ostream& out, uint64_t byte_count,
+                                        const std::map<unsigned char, uint32_t>& model) {
+    if (!readAll(in, input_buffer)) {
+        std::cerr << "Error reading codestream." << std::endl;
+        return false;
+    }
+
+    return decodeWithModelBuffer(input_buffer.data(), input_buffer.size(), byte_count, model) &&
+           writeAll(out, output_buffer);
+}
+
+bool ArithmeticDecoder::decodeWithModelBuffer(const uint8_t* data, size_t size, uint64_t byte_count,
+                                              const std::map<unsigned char, uint32_t>& model) {
+    output_buffer.clear();
+    uint64_t cum = loadModel(model);
+
+    if (cum == 0 || cum > MAX_FREQ_SUM) {
+        std::cerr << "Error: Model frequency sum (" << cum
+                  << ") must be between 1 and " << MAX_FREQ_SUM << "." << std::endl;
+        return false;
+    }
+    if (byte_count > MAX_FREQ_SUM) {
+        std::cerr << "Error: Byte count (" << byte_count
+                  << ") exceeds maximum allowed (" << MAX_FREQ_SUM << ")." << std::endl;
+        return false;
+    }
+
+    if (byte_count == 0) {
+        return true;
+    }
+
+    return decodeSymbols(data, size, byte_count);
+}
+
+bool ArithmeticDecoder::decodeSymbols(const uint8_t* data, size_t size, uint64_t total_bytes_to_decode) {
+    BitIO bit_io_obj(data, size);
     bit_io = &bit_io_obj;
 
     low = 0;
     high = TOP_VALUE;
     if (!initializeDecoder()) {
-        infile.close();
-        outfile.close();
-        std::remove(output_filename.c_str());
+        bit_io = nullptr;
         return false;
     }
 
-    uint64_t bytes_decoded = 0;
-    try {
-        for (; bytes_decoded < total_bytes_to_decode; ++bytes_decoded) {
-            uint64_t range = (uint64_t)high - low + 1;
-            if (range == 0) {
-                std::cerr << "Error: Decoder range became zero at byte " << bytes_decoded << "." << std::endl;
-                infile.close(); outfile.close(); std::remove(output_filename.c_str()); return false;
-            }
-
-            uint64_t scaled_value = (((uint64_t)value - low + 1) * total_freq_sum - 1) / range;
-            unsigned char decoded_byte = findSymbol(scaled_value, lookup_symbol);
-
-            outfile.put(static_cast<char>(decoded_byte));
-
-            auto freq_it = frequency.find(decoded_byte);
-            auto cum_freq_it = cumulative_frequency.find(decoded_byte);
-            if (freq_it == frequency.end() || cum_freq_it == cumulative_frequency.end()) {
-                std::cerr << "Internal Error: Decoded byte " << (int)decoded_byte << " not found in frequency tables." << std::endl;
-                infile.close(); outfile.close(); std::remove(output_filename.c_str()); return false;
-            }
-            uint32_t sym_freq = freq_it->second;
-            uint64_t sym_cum_freq = cum_freq_it->second;
-
-            high = low + (uint32_t)((range * (sym_cum_freq + sym_freq)) / total_freq_sum) - 1;
-            low = low + (uint32_t)((range * sym_cum_freq) / total_freq_sum);
-
-            for (;;) {
-                if (high < HALF) {
-                } else if (low >= HALF) {
-                    low -= HALF; high -= HALF; value -= HALF;
-                } else if (low >= FIRST_QTR && high < THIRD_QTR) {
-                    low -= FIRST_QTR; high -= FIRST_QTR; value -= FIRST_QTR;
-                } else {
-                    break;
-                }
-                low <<= 1;
-                high = (high << 1) + 1;
-                int bit = inputBit();
-                value = (value << 1) | (bit == -1 ? 0 : bit);
-            }
-        }
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Runtime error during decoding: " << e.what() << std::endl;
-        infile.close(); outfile.close(); std::remove(output_filename.c_str()); return false;
+    for (uint64_t bytes_decoded = 0; bytes_decoded < total_bytes_to_decode; ++bytes_decoded) {
+        unsigned char decoded_byte = findSymbol(scaledValue(total_freq_sum));
+        output_buffer.push_back(decoded_byte);
+        consumeInterval(cumulative[decoded_byte], frequency[decoded_byte], total_freq_sum);
     }
+    bit_io = nullptr;
 
-    infile.close();
-    outfile.close();
+    return true;
+}
 
-    if (bytes_decoded != total_bytes_to_decode) {
-        std::cerr << "Error: Decoded " << bytes_decoded << " bytes, but expected " << total_bytes_to_decode << " from header." << std::endl;
+bool ArithmeticDecoder::decodeAdaptive(std::istream& in, std::ostream& out) {
+    if (!readAll(in, input_buffer)) {
+        std::cerr << "Error reading codestream." << std::endl;
         return false;
     }
-    if (!outfile) {
-        std::cerr << "Error occurred during final write/close of file: " << output_filename << std::endl;
+
+    return decodeAdaptiveBuffer(input_buffer.data(), input_buffer.size()) &&
+           writeAll(out, output_buffer);
+}
+
+bool ArithmeticDecoder::decodeAdaptiveBuffer(const uint8_t* data, size_t size) {
+    output_buffer.clear();
+
+    size_t pos = 0;
+    uint64_t total_bytes_to_decode;
+    if (!loadValue(data, size, pos, total_bytes_to_decode)) {
+        std::cerr << "Error reading total byte count from header." << std::endl;
+        return false;
+    }
+    if (total_bytes_to_decode > MAX_FREQ_SUM) {
+        std::cerr << "Error: Total byte count (" << total_bytes_to_decode
+                  << ") read from header exceeds maximum allowed (" << MAX_FREQ_SUM << ")." << std::endl;
+        return false;
+    }
+    if (total_bytes_to_decode == 0) {
+        return true;
+    }
+
+    scratch.reset();
+    adaptive_model.reset(scratch);
+    BitIO bit_io_obj(data + pos, size - pos);
+    bit_io = &bit_io_obj;
+
+    low = 0;
+    high = TOP_VALUE;
+    if (!initializeDecoder()) {
+        bit_io = nullptr;
         return false;
     }
 
+    unsigned char context = 0;
+    for (uint64_t i = 0; i < total_bytes_to_decode; ++i) {
+        adaptive_model.prepare(context);
+        uint32_t total = adaptive_model.total(context);
+        unsigned char decoded_byte = adaptive_model.findSymbol(context, (uint32_t)scaledValue(total));
+        consumeInterval(adaptive_model.cumulative(context, decoded_byte),
+                        adaptive_model.frequency(context, decoded_byte), total);
+        adaptive_model.update(context, decoded_byte);
+        output_buffer.push_back(decoded_byte);
+        context = decoded_byte;
+    }
+    bit_io = nullptr;
+
     return true;
-}
\ No newline at end of file
+}
+
+const std::vector<uint8_t>& ArithmeticDecoder::getOutput() const {
+    return output_buffer;
+}
+
+uint64_t ArithmeticDecoder::scaledValue(uint64_t freq_total) const {
+    uint64_t range = (uint64_t)high - low + 1;
+    return (((uint64_t)value - low + 1) * freq_total - 1) / range;
+}
+
+void ArithmeticDecoder::consumeInterval(uint64_t cum_freq, uint32_t freq, uint64_t freq_total) {
+    uint64_t range = (uint64_t)high - low + 1;
+
+    high = low + (uint32_t)((range * (cum_freq + freq)) / freq_total) - 1;
+    low = low + (uint32_t)((range * cum_freq) / freq_total);
+
+    for (;;) {
+        if (high < HALF) {
+        } else if (low >= HALF) {
+            low -= HALF; high -= HALF; value -= HALF;
+        } else if (low >= FIRST_QTR && high < THIRD_QTR) {
+            low -= FIRST_QTR; high -= FIRST_QTR; value -= FIRST_QTR;
+        } else {
+            break;
+        }
+        low <<= 1;
+        high = (high << 1) + 1;
+        int bit = inputBit();
+        value = (value << 1) | (bit == -1 ? 0 : bit);
+    }
+}
@@ -2,9 +2,17 @@
 #define ARITHMETIC_CODER_HPP
 
 #include <string>
+#include <vector>
 #include <map>
 #include <cstdint>
 #include "bit_io.hpp"
+#include "scratch_arena.hpp"
+#include "adaptive_model.hpp"
+
+// Encoder and decoder objects are reusable contexts: model tables are fixed
+// arrays, input/output buffers keep their capacity between calls, and
+// per-call scratch comes from an arena. Once warmed up on the largest input,
+// the *Buffer entry points code further files without heap allocations.
 
 class ArithmeticEncoder {
 private:
@@ -14,17 +22,39 @@ private:
     BitIO* bit_io;
     uint64_t total_byte_count;
 
+    uint32_t frequency[256];
+    uint64_t cumulative[257];
+    std::vector<uint8_t> input_buffer;
+    std::vector<uint8_t> output_buffer;
+    ScratchArena scratch;
+    AdaptiveContextModel adaptive_model;
+
     void outputBitPlusFollow(int bit);
-    uint64_t calculateByteFrequencyTables(std::istream& in,
-                                          std::map<unsigned char, uint32_t>& frequency,
-                                          std::map<unsigned char, uint64_t>& cumulative);
-    bool writeHeader(std::ostream& out,
-                     uint64_t total_bytes,
-                     const std::map<unsigned char, uint32_t>& frequency);
+    void encodeInterval(uint64_t cum_freq, uint32_t freq, uint64_t freq_total);
+    void finishEncoding();
+    void writeHeader(uint64_t total_bytes);
+    uint64_t loadModel(const std::map<unsigned char, uint32_t>& model);
+    bool encodeSymbols(const uint8_t* data, size_t size, uint64_t freq_total);
 
 public:
     ArithmeticEncoder();
+    // Byte histogram and cumulative table shared by every static-model engine.
+    static uint64_t calculateByteFrequencyTables(const uint8_t* data, size_t size,
+                                                 uint32_t frequency[256],
+                                                 uint64_t cumulative[257]);
+
     bool encode(const std::string& input_filename, const std::string& output_filename);
+    bool encodeStream(std::istream& in, std::ostream& out);
+    // Codes every byte of `in` against a caller-supplied model; no header is written.
+    bool encodeWithModel(std::istream& in, std::ostream& out,
+                         const std::map<unsigned char, uint32_t>& frequency);
+    // Order-1 adaptive model; no table is stored, only the byte count.
+    bool encodeAdaptive(std::istream& in, std::ostream& out);
+
+    // In-memory variants; the codestream is left in getOutput().
+    bool encodeBuffer(const uint8_t* data, size_t size);
+    bool encodeAdaptiveBuffer(const uint8_t* data, size_t size);
+    const std::vector<uint8_t>& getOutput() const;
 };
 
 class ArithmeticDecoder {
@@ -35,18 +65,41 @@ private:
     BitIO* bit_io;
     uint64_t total_freq_sum;
 
+    uint32_t frequency[256];
+    uint64_t cumulative[257];
+    uint8_t active_symbols[256];
+    uint64_t active_cumulative[256];
+    uint32_t active_count;
+    std::vector<uint8_t> input_buffer;
+    std::vector<uint8_t> output_buffer;
+    ScratchArena scratch;
+    AdaptiveContextModel adaptive_model;
+
     int inputBit();
-    bool readHeader(std::istream& in,
-                   uint64_t& total_bytes_to_decode,
-                   std::map<unsigned char, uint32_t>& frequency,
-                   std::map<unsigned char, uint64_t>& cumulative,
-                   std::map<uint64_t, unsigned char>& lookup_symbol);
-    unsigned char findSymbol(uint64_t scaled_value, const std::map<uint64_t, unsigned char>& lookup_symbol);
+    bool readHeader(const uint8_t* data, size_t size, size_t& header_size, uint64_t& total_bytes_to_decode);
+    bool buildLookup();
+    uint64_t loadModel(const std::map<unsigned char, uint32_t>& model);
+    unsigned char findSymbol(uint64_t scaled_value) const;
+    uint64_t scaledValue(uint64_t freq_total) const;
+    void consumeInterval(uint64_t cum_freq, uint32_t freq, uint64_t freq_total);
     bool initializeDecoder();
+    bool decodeSymbols(const uint8_t* data, size_t size, uint64_t total_bytes_to_decode);
 
 public:
     ArithmeticDecoder();
     bool decode(const std::string& input_filename, const std::string& output_filename);
+    bool decodeStream(std::istream& in, std::ostream& out);
+    // Inverse of ArithmeticEncoder::encodeWithModel; byte_count comes from the container.
+    bool decodeWithModel(std::istream& in, std::ostream& out, uint64_t byte_count,
+                         const std::map<unsigned char, uint32_t>& frequency);
+    bool decodeAdaptive(std::istream& in, std::ostream& out);
+
+    // In-memory variants; the decoded bytes are left in getOutput().
+    bool decodeBuffer(const uint8_t* data, size_t size);
+    bool decodeWithModelBuffer(const uint8_t* data, size_t size, uint64_t byte_count,
+                               const std::map<unsigned char, uint32_t>& frequency);
+    bool decodeAdaptiveBuffer(const uint8_t* data, size_t size);
+    const std::vector<uint8_t>& getOutput() const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,10 +1,20 @@
 #include "bit_io.hpp"
 
 BitIO::BitIO(std::ostream* os) 
-    : out_stream(os), in_stream(nullptr), buffer(0), bits_in_buffer(0), is_writing(true), bits_processed(0) {}
+    : out_stream(os), in_stream(nullptr), out_buffer(nullptr), in_data(nullptr), in_size(0), in_pos(0),
+      buffer(0), bits_in_buffer(0), is_writing(true), bits_processed(0) {}
 
 BitIO::BitIO(std::istream* is) 
-    : out_stream(nullptr), in_stream(is), buffer(0), bits_in_buffer(0), is_writing(false), bits_processed(0) {}
+    : out_stream(nullptr), in_stream(is), out_buffer(nullptr), in_data(nullptr), in_size(0), in_pos(0),
+      buffer(0), bits_in_buffer(0), is_writing(false), bits_processed(0) {}
+
+BitIO::BitIO(std::vector<uint8_t>* out)
+    : out_stream(nullptr), in_stream(nullptr), out_buffer(out), in_data(nullptr), in_size(0), in_pos(0),
+      buffer(0), bits_in_buffer(0), is_writing(true), bits_processed(0) {}
+
+BitIO::BitIO(const uint8_t* data, size_t size)
+    : out_stream(nullptr), in_stream(nullptr), out_buffer(nullptr), in_data(data), in_size(size), in_pos(0),
+      buffer(0), bits_in_buffer(0), is_writing(false), bits_processed(0) {}
 
 BitIO::~BitIO() {
     if (is_writing && bits_in_buffer > 0) {
@@ -12,26 +22,39 @@ BitIO::~BitIO() {
     }
 }
 
+void BitIO::putByte(unsigned char byte) {
+    if (out_buffer) {
+        out_buffer->push_back(byte);
+    } else {
+        out_stream->put(byte);
+    }
+}
+
 void BitIO::writeBit(int bit) {
-    if (!is_writing || !out_stream || !out_stream->good()) return;
+    if (!is_writing || (!out_buffer && (!out_stream || !out_stream->good()))) return;
     buffer = (buffer << 1) | (bit & 1);
     bits_in_buffer++;
     bits_processed++;
     if (bits_in_buffer == 8) {
-        out_stream->put(buffer);
+        putByte(buffer);
         buffer = 0;
         bits_in_buffer = 0;
     }
 }
 
 int BitIO::readBit() {
-    if (is_writing || !in_stream || in_stream->eof()) return -1;
+    if (is_writing) return -1;
     if (bits_in_buffer == 0) {
-        char c;
-        if (!in_stream->get(c)) {
-            return -1;
+        if (in_data) {
+            if (in_pos >= in_size) return -1;
+            buffer = in_data[in_pos++];
+        } else {
+            char c;
+            if (!in_stream || in_stream->eof() || !in_stream->get(c)) {
+                return -1;
+            }
+            buffer = static_cast<unsigned char>(c);
         }
-        buffer = static_cast<unsigned char>(c);
         bits_in_buffer = 8;
     }
     bits_in_buffer--;
@@ -41,13 +64,14 @@ int BitIO::readBit() {
 }
 
 void BitIO::flush() {
-    if (!is_writing || !out_stream || !out_stream->good() || bits_in_buffer == 0) return;
+    if (!is_writing || bits_in_buffer == 0) return;
+    if (!out_buffer && (!out_stream || !out_stream->good())) return;
     buffer <<= (8 - bits_in_buffer);
-    out_stream->put(buffer);
+    putByte(buffer);
     buffer = 0;
     bits_in_buffer = 0;
 }
 
 uint64_t BitIO::getBitsProcessed() const { 
     return bits_processed; 
-}
\ No newline at end of file
+}
@@ -2,20 +2,30 @@
 #define BIT_IO_HPP
 
 #include <iostream>
+#include <vector>
 #include <cstdint>
 
 class BitIO {
 private:
     std::ostream* out_stream;
     std::istream* in_stream;
+    std::vector<uint8_t>* out_buffer;
+    const uint8_t* in_data;
+    size_t in_size;
+    size_t in_pos;
     unsigned char buffer;
     int bits_in_buffer;
     bool is_writing;
     uint64_t bits_processed;
 
+    void putByte(unsigned char byte);
+
 public:
     BitIO(std::ostream* os);
     BitIO(std::istream* is);
+    // Memory-backed variants: append to a caller-owned buffer / read a span.
+    BitIO(std::vector<uint8_t>* out);
+    BitIO(const uint8_t* data, size_t size);
     ~BitIO();
 
     void writeBit(int bit);
@@ -24,4 +34,4 @@ public:
     uint64_t getBitsProcessed() const;
 };
 
-#endif
\ No newline at end of file
+#endif
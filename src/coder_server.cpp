@@ -0,0 +1,543 @@
+#include "coder_server.hpp"
+#include "near_lossless.hpp"
+#include "constants.hpp"
+#include "utils.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <exception>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <signal.h>
+#endif
+
+namespace {
+
+const size_t MAX_COMMAND_LINE = 8192;
+const uint64_t MAX_INLINE_PAYLOAD = (uint64_t)1 << 28;
+const uint64_t MAX_INLINE_RESPONSE = (uint64_t)1 << 28;
+const int IO_TIMEOUT_SECONDS = 10;
+const int POLL_INTERVAL_MS = 500;
+
+#ifndef _WIN32
+bool readExact(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::read(fd, data, size);
+        if (n <= 0) return false;
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+bool readLine(int fd, std::string& line) {
+    line.clear();
+    char c;
+    while (line.size() < MAX_COMMAND_LINE) {
+        if (!readExact(fd, &c, 1)) return false;
+        if (c == '\n') return true;
+        line.push_back(c);
+    }
+    return false;
+}
+
+enum ReadStatus { READ_COMPLETE, READ_PENDING, READ_FAILED };
+
+// Non-blocking: consumes whatever part of the command line has arrived.
+// Reads one byte at a time so payload bytes stay in the socket.
+ReadStatus readAvailableLine(int fd, std::string& line) {
+    for (;;) {
+        char c;
+        ssize_t n = ::recv(fd, &c, 1, MSG_DONTWAIT);
+        if (n == 1) {
+            if (c == '\n') return READ_COMPLETE;
+            if (line.size() >= MAX_COMMAND_LINE) return READ_FAILED;
+            line.push_back(c);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return READ_PENDING;
+        return READ_FAILED;
+    }
+}
+
+// Non-blocking: appends whatever part of the payload has arrived. The buffer
+// grows with the bytes received, not with the size the client announced.
+ReadStatus readAvailablePayload(int fd, std::string& payload, uint64_t size) {
+    char chunk[65536];
+    while (payload.size() < size) {
+        size_t wanted = (size_t)std::min<uint64_t>(sizeof(chunk), size - payload.size());
+        ssize_t n = ::recv(fd, chunk, wanted, MSG_DONTWAIT);
+        if (n > 0) {
+            payload.append(chunk, (size_t)n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return READ_PENDING;
+        return READ_FAILED;
+    }
+    return READ_COMPLETE;
+}
+
+void setSocketTimeouts(int fd) {
+    timeval timeout;
+    timeout.tv_sec = IO_TIMEOUT_SECONDS;
+    timeout.tv_usec = 0;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+bool sendResponse(int fd, bool success, const std::string& response) {
+    std::string status = (success ? "OK\t" : "ERR\t") + std::to_string(response.size()) + "\n";
+    return writeAll(fd, status.data(), status.size()) &&
+           writeAll(fd, response.data(), response.size());
+}
+
+bool fillSocketAddress(const std::string& path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Error: Invalid socket path: " << path << std::endl;
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+bool hasMagic(const std::string& payload, const char (&magic)[4]) {
+    return payload.size() >= sizeof(magic) && std::memcmp(payload.data(), magic, sizeof(magic)) == 0;
+}
+
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    std::string::size_type start = 0;
+    for (;;) {
+        std::string::size_type tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab - start));
+        if (tab == std::string::npos) break;
+        start = tab + 1;
+    }
+    return fields;
+}
+
+bool isInlineCommand(const std::vector<std::string>& fields) {
+    return (fields[0] == "ENCODE_INLINE" && (fields.size() == 2 || fields.size() == 3)) ||
+           (fields[0] == "DECODE_INLINE" && fields.size() == 2);
+}
+
+bool parsePayloadSize(const std::string& text, uint64_t& size) {
+    char* end = nullptr;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str() || *end != '\0' || text[0] == '-' || value > MAX_INLINE_PAYLOAD) {
+        return false;
+    }
+    size = value;
+    return true;
+}
+#endif
+
+}
+
+CoderServer::CoderServer(const std::string& path, unsigned workers)
+    : socket_path(path), worker_count(workers == 0 ? 1 : workers), listen_fd(-1), stopping(false) {}
+
+CoderServer::~CoderServer() {
+#ifndef _WIN32
+    if (listen_fd >= 0) {
+        ::close(listen_fd);
+        ::unlink(socket_path.c_str());
+    }
+#endif
+}
+
+#ifdef _WIN32
+
+bool CoderServer::run() {
+    std::cerr << "Error: serve mode requires Unix domain sockets and is not supported on this platform." << std::endl;
+    return false;
+}
+
+void CoderServer::workerLoop() {}
+void CoderServer::dispatchRequest(PendingRequest&) {}
+bool CoderServer::handleControlRequest(int, const std::string&) { return false; }
+bool CoderServer::readPendingRequest(PendingRequest&, bool&) { return false; }
+bool CoderServer::handleRequest(PendingRequest&, WorkerContext&) { return false; }
+void CoderServer::requestShutdown() {}
+
+#else
+
+bool CoderServer::run() {
+    sockaddr_un addr;
+    if (!fillSocketAddress(socket_path, addr)) return false;
+
+    signal(SIGPIPE, SIG_IGN);
+
+    listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        std::cerr << "Error creating socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    ::unlink(socket_path.c_str());
+    if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd, 64) != 0) {
+        std::cerr << "Error binding socket " << socket_path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < worker_count; ++i) {
+        workers.push_back(std::thread(&CoderServer::workerLoop, this));
+    }
+    std::cout << "Listening on " << socket_path << " with " << worker_count << " worker(s)." << std::endl;
+
+    // Connections whose command line or inline payload is still arriving.
+    std::vector<PendingRequest> reading;
+    std::vector<pollfd> poll_fds;
+    while (!stopping) {
+        poll_fds.clear();
+        pollfd listen_poll = {listen_fd, POLLIN, 0};
+        poll_fds.push_back(listen_poll);
+        for (const auto& pending : reading) {
+            pollfd client_poll = {pending.client_fd, POLLIN, 0};
+            poll_fds.push_back(client_poll);
+        }
+
+        if (::poll(poll_fds.data(), poll_fds.size(), POLL_INTERVAL_MS) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Error polling sockets: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        auto now = std::chrono::high_resolution_clock::now();
+        size_t kept = 0;
+        for (size_t i = 0; i < reading.size(); ++i) {
+            PendingRequest& pending = reading[i];
+            bool complete = false;
+            bool alive = true;
+            if (poll_fds[i + 1].revents != 0) {
+                alive = readPendingRequest(pending, complete);
+            }
+            if (complete) {
+                dispatchRequest(pending);
+            } else if (!alive || now - pending.last_activity > std::chrono::seconds(IO_TIMEOUT_SECONDS)) {
+                ::close(pending.client_fd);
+                recordRequest(false, std::chrono::duration<double, std::milli>(now - pending.accepted_at).count());
+            } else {
+                if (kept != i) reading[kept] = std::move(pending);
+                kept++;
+            }
+        }
+        reading.resize(kept);
+
+        if (stopping || !(poll_fds[0].revents & POLLIN)) continue;
+        int client_fd = ::accept(listen_fd, nullptr, nullptr);
+        if (client_fd < 0) {
+            if (errno != EINTR && errno != EAGAIN) {
+                std::cerr << "Error accepting connection: " << std::strerror(errno) << std::endl;
+            }
+            continue;
+        }
+        setSocketTimeouts(client_fd);
+
+        PendingRequest pending;
+        pending.client_fd = client_fd;
+        pending.accepted_at = std::chrono::high_resolution_clock::now();
+        pending.last_activity = pending.accepted_at;
+        reading.push_back(pending);
+    }
+
+    for (const auto& pending : reading) {
+        ::close(pending.client_fd);
+    }
+    queue_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    ::close(listen_fd);
+    listen_fd = -1;
+    ::unlink(socket_path.c_str());
+    std::cout << "Server stopped." << std::endl << formatStats();
+    return true;
+}
+
+void CoderServer::requestShutdown() {
+    stopping = true;
+    queue_cv.notify_all();
+}
+
+bool CoderServer::readPendingRequest(PendingRequest& pending, bool& complete) {
+    size_t received = pending.command_line.size() + pending.payload.size();
+    ReadStatus status = READ_COMPLETE;
+    if (!pending.line_complete) {
+        status = readAvailableLine(pending.client_fd, pending.command_line);
+        if (status == READ_COMPLETE) {
+            pending.line_complete = true;
+            // A bad size is reported by the worker; nothing more is read.
+            std::vector<std::string> fields = splitFields(pending.command_line);
+            if (!isInlineCommand(fields) || !parsePayloadSize(fields[1], pending.payload_size)) {
+                pending.payload_size = 0;
+            }
+        }
+    }
+    if (status == READ_COMPLETE) {
+        status = readAvailablePayload(pending.client_fd, pending.payload, pending.payload_size);
+    }
+    if (pending.command_line.size() + pending.payload.size() != received) {
+        pending.last_activity = std::chrono::high_resolution_clock::now();
+    }
+    complete = status == READ_COMPLETE;
+    return status != READ_FAILED;
+}
+
+void CoderServer::dispatchRequest(PendingRequest& pending) {
+    const std::string& line = pending.command_line;
+    if (line == "STATS" || line == "SHUTDOWN") {
+        bool success = handleControlRequest(pending.client_fd, line);
+        ::close(pending.client_fd);
+        std::chrono::duration<double, std::milli> latency =
+            std::chrono::high_resolution_clock::now() - pending.accepted_at;
+        recordRequest(success, latency.count());
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        queue.push_back(std::move(pending));
+        std::lock_guard<std::mutex> stats_lock(stats_mutex);
+        if (queue.size() > stats.max_queue_depth) stats.max_queue_depth = queue.size();
+    }
+    queue_cv.notify_one();
+}
+
+bool CoderServer::handleControlRequest(int client_fd, const std::string& command_line) {
+    if (command_line == "STATS") {
+        return sendResponse(client_fd, true, formatStats());
+    }
+    requestShutdown();
+    return sendResponse(client_fd, true, "shutting down");
+}
+
+void CoderServer::workerLoop() {
+    WorkerContext context;
+
+    for (;;) {
+        PendingRequest pending;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            pending = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        bool success = handleRequest(pending, context);
+        ::close(pending.client_fd);
+
+        std::chrono::duration<double, std::milli> latency =
+            std::chrono::high_resolution_clock::now() - pending.accepted_at;
+        recordRequest(success, latency.count());
+    }
+}
+
+bool CoderServer::handleRequest(PendingRequest& pending, WorkerContext& context) {
+    const std::string& line = pending.command_line;
+    std::vector<std::string> fields = splitFields(line);
+    const std::string& command = fields[0];
+    std::string& response = context.response_payload;
+    response.clear();
+    bool success = false;
+
+    // Payloads are untrusted; a codec that runs out of memory on one must
+    // fail that request, not the worker thread and the whole server.
+    try {
+        if ((command == "ENCODE" || command == "DECODE" || command == "VERIFY") && fields.size() == 3) {
+            if (command == "ENCODE") {
+                success = context.encoder.encode(fields[1], fields[2]);
+            } else if (command == "DECODE") {
+                if (isNearLosslessCodestream(fields[1])) {
+                    NearLosslessDecoder decoder;
+                    success = decoder.decode(fields[1], fields[2]);
+                } else if (isLevelCodestream(fields[1])) {
+                    success = context.level_decoder.decode(fields[1], fields[2]);
+                } else {
+                    success = context.decoder.decode(fields[1], fields[2]);
+                }
+            } else {
+                std::ifstream codestream(fields[1], std::ios::binary);
+                std::ostringstream decoded;
+                if (!codestream.is_open()) {
+                    response = "cannot open codestream " + fields[1];
+                } else if (isNearLosslessCodestream(fields[1])) {
+                    response = "VERIFY supports lossless codestreams only";
+                } else if (!(isLevelCodestream(fields[1]) ? context.level_decoder.decodeStream(codestream, decoded)
+                                                          : context.decoder.decodeStream(codestream, decoded))) {
+                    response = "decode failed";
+                } else if (!readFileContents(fields[2], context.original)) {
+                    response = "cannot open original " + fields[2];
+                } else if (decoded.str() != context.original) {
+                    response = "mismatch";
+                } else {
+                    success = true;
+                    response = "match";
+                }
+            }
+            if (response.empty()) response = success ? "done" : "failed";
+        } else if (isInlineCommand(fields)) {
+            uint64_t size = 0;
+            long level = 0;
+            if (fields.size() == 3) {
+                char* level_end = nullptr;
+                level = std::strtol(fields[2].c_str(), &level_end, 10);
+                if (level_end == fields[2].c_str() || *level_end != '\0' ||
+                    level < MIN_COMPRESSION_LEVEL || level > MAX_COMPRESSION_LEVEL) {
+                    level = -1;
+                }
+            }
+            if (!parsePayloadSize(fields[1], size)) {
+                response = "invalid payload size";
+            } else if (level < 0) {
+                response = "invalid compression level: " + fields[2];
+            } else {
+                const std::string& payload = pending.payload;
+                // Legacy streams use the buffer entry points, which reuse the
+                // worker's coder buffers; tagged streams go through their codecs.
+                const uint8_t* data = reinterpret_cast<const uint8_t*>(payload.data());
+                const std::vector<uint8_t>* output = nullptr;
+                std::istringstream in(payload);
+                std::ostringstream out;
+                if (command == "ENCODE_INLINE" && level > 0) {
+                    success = context.level_encoder.encodeStream(in, out, (int)level);
+                } else if (command == "ENCODE_INLINE") {
+                    success = context.encoder.encodeBuffer(data, payload.size());
+                    output = &context.encoder.getOutput();
+                } else if (hasMagic(payload, NEAR_LOSSLESS_MAGIC)) {
+                    success = context.near_lossless_decoder.decodeStream(in, out);
+                } else if (hasMagic(payload, LEVEL_MAGIC)) {
+                    success = context.level_decoder.decodeStream(in, out);
+                } else {
+                    success = context.decoder.decodeBuffer(data, payload.size());
+                    output = &context.decoder.getOutput();
+                }
+                if (!success) {
+                    response = command == "ENCODE_INLINE" ? "encode failed" : "decode failed";
+                } else if (output) {
+                    response.assign(output->begin(), output->end());
+                } else {
+                    response = out.str();
+                }
+            }
+        } else {
+            response = "unknown command: " + line;
+        }
+    } catch (const std::exception& e) {
+        success = false;
+        response = std::string("internal error: ") + e.what();
+    }
+    if (success && response.size() > MAX_INLINE_RESPONSE) {
+        success = false;
+        response = "response exceeds " + std::to_string(MAX_INLINE_RESPONSE) + " bytes";
+    }
+
+    return sendResponse(pending.client_fd, success, response) && success;
+}
+
+#endif
+
+void CoderServer::recordRequest(bool success, double latency_ms) {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    stats.requests_completed++;
+    if (!success) stats.requests_failed++;
+    stats.total_latency_ms += latency_ms;
+    if (latency_ms > stats.max_latency_ms) stats.max_latency_ms = latency_ms;
+}
+
+std::string CoderServer::formatStats() {
+    size_t queue_depth;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        queue_depth = queue.size();
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    out << "workers:          " << worker_count << "\n"
+        << "queue_depth:      " << queue_depth << "\n"
+        << "max_queue_depth:  " << stats.max_queue_depth << "\n"
+        << "requests:         " << stats.requests_completed << "\n"
+        << "failed:           " << stats.requests_failed << "\n"
+        << "mean_latency_ms:  " << (stats.requests_completed ? stats.total_latency_ms / stats.requests_completed : 0.0) << "\n"
+        << "max_latency_ms:   " << stats.max_latency_ms << "\n";
+    return out.str();
+}
+
+CoderClient::CoderClient(const std::string& path) : socket_path(path) {}
+
+bool CoderClient::request(const std::string& command_line, const std::string& payload,
+                          bool& server_ok, std::string& response_payload) {
+#ifdef _WIN32
+    (void)command_line; (void)payload; (void)server_ok; (void)response_payload;
+    std::cerr << "Error: client mode requires Unix domain sockets and is not supported on this platform." << std::endl;
+    return false;
+#else
+    sockaddr_un addr;
+    if (!fillSocketAddress(socket_path, addr)) return false;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Error connecting to " << socket_path << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+
+    std::string header = command_line + "\n";
+    std::string status;
+    bool ok = writeAll(fd, header.data(), header.size()) &&
+              writeAll(fd, payload.data(), payload.size()) &&
+              readLine(fd, status);
+    if (!ok) {
+        std::cerr << "Error: Connection to server failed." << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    std::vector<std::string> fields = splitFields(status);
+    if (fields.size() != 2 || (fields[0] != "OK" && fields[0] != "ERR")) {
+        std::cerr << "Error: Malformed response from server: " << status << std::endl;
+        ::close(fd);
+        return false;
+    }
+    server_ok = fields[0] == "OK";
+    response_payload.resize((size_t)std::strtoull(fields[1].c_str(), nullptr, 10));
+    if (!response_payload.empty() && !readExact(fd, &response_payload[0], response_payload.size())) {
+        std::cerr << "Error: Truncated response from server." << std::endl;
+        ::close(fd);
+        return false;
+    }
+    ::close(fd);
+    return true;
+#endif
+}
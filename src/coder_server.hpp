@@ -0,0 +1,100 @@
+#ifndef CODER_SERVER_HPP
+#define CODER_SERVER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "arithmetic_coder.hpp"
+#include "level_codec.hpp"
+#include "near_lossless.hpp"
+
+// Request framing over the Unix socket, one request per connection:
+//   request:  COMMAND[\targ...]\n followed by <payload_size> raw bytes for *_INLINE
+//   response: OK|ERR\t<payload_size>\n followed by the payload bytes
+// Commands: ENCODE in out | DECODE in out | VERIFY codestream original |
+//           ENCODE_INLINE size [level] | DECODE_INLINE size | STATS | SHUTDOWN
+// ENCODE_INLINE writes the untagged format unless a level is given; decoding
+// picks the codec from the payload's magic, like DECODE does for files.
+// The accept thread reads each command line and inline payload without
+// blocking and answers STATS and SHUTDOWN itself; workers only see complete
+// coding requests, so a stalled client never holds one. Client sockets time
+// out after IO_TIMEOUT_SECONDS of inactivity.
+class CoderServer {
+private:
+    struct PendingRequest {
+        int client_fd;
+        std::chrono::high_resolution_clock::time_point accepted_at;
+        std::chrono::high_resolution_clock::time_point last_activity;
+        std::string command_line;
+        bool line_complete;
+        uint64_t payload_size;
+        std::string payload;
+
+        PendingRequest() : client_fd(-1), line_complete(false), payload_size(0) {}
+    };
+
+    // Owned by a single worker thread and reused across requests.
+    struct WorkerContext {
+        ArithmeticEncoder encoder;
+        ArithmeticDecoder decoder;
+        LevelEncoder level_encoder;
+        LevelDecoder level_decoder;
+        NearLosslessDecoder near_lossless_decoder;
+        std::string original;
+        std::string response_payload;
+    };
+
+    struct Stats {
+        uint64_t requests_completed;
+        uint64_t requests_failed;
+        uint64_t max_queue_depth;
+        double total_latency_ms;
+        double max_latency_ms;
+
+        Stats() : requests_completed(0), requests_failed(0), max_queue_depth(0),
+                  total_latency_ms(0.0), max_latency_ms(0.0) {}
+    };
+
+    std::string socket_path;
+    unsigned worker_count;
+    int listen_fd;
+    std::atomic<bool> stopping;
+
+    std::deque<PendingRequest> queue;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+
+    Stats stats;
+    std::mutex stats_mutex;
+
+    void workerLoop();
+    bool readPendingRequest(PendingRequest& pending, bool& complete);
+    void dispatchRequest(PendingRequest& pending);
+    bool handleControlRequest(int client_fd, const std::string& command_line);
+    bool handleRequest(PendingRequest& pending, WorkerContext& context);
+    void recordRequest(bool success, double latency_ms);
+    std::string formatStats();
+    void requestShutdown();
+
+public:
+    CoderServer(const std::string& path, unsigned workers);
+    ~CoderServer();
+    bool run();
+};
+
+class CoderClient {
+private:
+    std::string socket_path;
+
+public:
+    CoderClient(const std::string& path);
+    bool request(const std::string& command_line, const std::string& payload,
+                 bool& server_ok, std::string& response_payload);
+};
+
+#endif
@@ -11,4 +11,19 @@ const uint32_t HALF = 2 * FIRST_QTR;
 const uint32_t THIRD_QTR = 3 * FIRST_QTR;
 const uint64_t MAX_FREQ_SUM = ((uint64_t)1 << 28);
 
+// Tagged codestreams start with a 4-byte magic. Read as the legacy uint64
+// byte count it always exceeds MAX_FREQ_SUM, so untagged files stay unambiguous.
+const char NEAR_LOSSLESS_MAGIC[4] = {'A', 'C', 'N', 'L'};
+const uint32_t MAX_NEAR_LOSSLESS_ERROR = 15;
+
+const char LEVEL_MAGIC[4] = {'A', 'C', 'L', 'V'};
+const int MIN_COMPRESSION_LEVEL = 1;
+const int MAX_COMPRESSION_LEVEL = 9;
+// One representative level per engine; the other levels alias to their tier.
+const int ENGINE_LEVELS[] = {1, 5, 9};
+
+const char ARCHIVE_MAGIC[4] = {'A', 'C', 'A', 'R'};
+const uint32_t ARCHIVE_VERSION = 1;
+const uint32_t ARCHIVE_FLAG_SHARED_MODEL = 1;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,272 @@
+#include "huffman_coder.hpp"
+#include "arithmetic_coder.hpp"
+#include "utils.hpp"
+#include <queue>
+#include <functional>
+#include <utility>
+
+namespace {
+
+const uint32_t MAX_CODE_LENGTH = 15;
+
+// Canonical code assignment: shorter codes first, ties broken by symbol value.
+void assignCanonicalCodes(const uint8_t lengths[256], uint32_t next_code[MAX_CODE_LENGTH + 2], uint32_t codes[256]) {
+    uint32_t bl_count[MAX_CODE_LENGTH + 2] = {0};
+    for (int s = 0; s < 256; ++s) {
+        if (lengths[s]) bl_count[lengths[s]]++;
+    }
+    uint32_t code = 0;
+    for (uint32_t len = 1; len <= MAX_CODE_LENGTH; ++len) {
+        code = (code + bl_count[len - 1]) << 1;
+        next_code[len] = code;
+    }
+    uint32_t assign[MAX_CODE_LENGTH + 2];
+    for (uint32_t len = 0; len <= MAX_CODE_LENGTH; ++len) assign[len] = next_code[len];
+    for (int s = 0; s < 256; ++s) {
+        if (lengths[s]) codes[s] = assign[lengths[s]]++;
+    }
+}
+
+}
+
+HuffmanEncoder::HuffmanEncoder() {}
+
+bool HuffmanEncoder::buildCodeLengths(const uint32_t frequency[256], uint8_t lengths[256]) {
+    uint64_t weights[256] = {0};
+    int used_symbols = 0;
+    int last_symbol = 0;
+    for (int s = 0; s < 256; ++s) {
+        if (frequency[s] == 0) continue;
+        weights[s] = frequency[s];
+        used_symbols++;
+        last_symbol = s;
+    }
+
+    for (int s = 0; s < 256; ++s) lengths[s] = 0;
+    if (used_symbols == 0) return true;
+    if (used_symbols == 1) {
+        lengths[last_symbol] = 1;
+        return true;
+    }
+
+    // Rebuild with flattened weights until the longest code fits the limit.
+    for (;;) {
+        typedef std::pair<uint64_t, int> Node;
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node> > heap;
+        int parent[511];
+        for (int s = 0; s < 256; ++s) {
+            parent[s] = -1;
+            if (weights[s]) heap.push(Node(weights[s], s));
+        }
+        int next_node = 256;
+        while (heap.size() > 1) {
+            Node a = heap.top(); heap.pop();
+            Node b = heap.top(); heap.pop();
+            parent[a.second] = next_node;
+            parent[b.second] = next_node;
+            parent[next_node] = -1;
+            heap.push(Node(a.first + b.first, next_node));
+            next_node++;
+        }
+
+        uint32_t longest = 0;
+        for (int s = 0; s < 256; ++s) {
+            if (!weights[s]) continue;
+            uint32_t depth = 0;
+            for (int n = s; parent[n] != -1; n = parent[n]) depth++;
+            lengths[s] = (uint8_t)(depth > 255 ? 255 : depth);
+            if (depth > longest) longest = depth;
+        }
+        if (longest <= MAX_CODE_LENGTH) return true;
+
+        for (int s = 0; s < 256; ++s) {
+            if (weights[s]) weights[s] = (weights[s] + 1) / 2;
+        }
+    }
+}
+
+bool HuffmanEncoder::encodeStream(std::istream& in, std::ostream& out) {
+    std::string input;
+    if (!readStreamContents(in, input)) {
+        std::cerr << "Error reading input stream during Huffman encoding." << std::endl;
+        return false;
+    }
+
+    uint32_t frequency[256];
+    uint64_t cumulative[257];
+    uint64_t total_bytes = ArithmeticEncoder::calculateByteFrequencyTables(
+        reinterpret_cast<const uint8_t*>(input.data()), input.size(), frequency, cumulative);
+    if (total_bytes != input.size()) {
+        return false;
+    }
+
+    uint8_t lengths[256];
+    uint32_t next_code[MAX_CODE_LENGTH + 2] = {0};
+    uint32_t codes[256] = {0};
+    if (!buildCodeLengths(frequency, lengths)) {
+        return false;
+    }
+    assignCanonicalCodes(lengths, next_code, codes);
+
+    out.write(reinterpret_cast<const char*>(&total_bytes), sizeof(total_bytes));
+    out.write(reinterpret_cast<const char*>(lengths), 256);
+    if (total_bytes == 0) {
+        return out.good();
+    }
+
+    std::string output;
+    output.reserve(input.size() / 2 + 16);
+    uint64_t acc = 0;
+    uint32_t nbits = 0;
+    for (char byte_char : input) {
+        unsigned char byte_val = static_cast<unsigned char>(byte_char);
+        acc = (acc << lengths[byte_val]) | codes[byte_val];
+        nbits += lengths[byte_val];
+        while (nbits >= 8) {
+            nbits -= 8;
+            output.push_back(static_cast<char>((acc >> nbits) & 0xFF));
+        }
+    }
+    if (nbits > 0) {
+        output.push_back(static_cast<char>((acc << (8 - nbits)) & 0xFF));
+    }
+
+    out.write(output.data(), output.size());
+    return out.good();
+}
+
+HuffmanDecoder::HuffmanDecoder() : table(1u << TABLE_BITS), max_length(0) {}
+
+int HuffmanDecoder::decodeSlow(uint64_t bits, uint32_t available, uint32_t& used) const {
+    uint32_t limit = available < max_length ? available : max_length;
+    for (uint32_t len = 1; len <= limit; ++len) {
+        uint32_t code = (uint32_t)(bits >> (64 - len));
+        uint32_t offset = code - first_code[len];
+        if (code >= first_code[len] && offset < length_count[len]) {
+            used = len;
+            return sorted_symbols[first_index[len] + offset];
+        }
+    }
+    return -1;
+}
+
+bool HuffmanDecoder::buildTables(const uint8_t lengths[256]) {
+    uint32_t codes[256];
+    uint64_t kraft = 0;
+    max_length = 0;
+    for (uint32_t len = 0; len <= MAX_CODE_LENGTH + 1; ++len) {
+        first_code[len] = 0;
+        first_index[len] = 0;
+        length_count[len] = 0;
+    }
+    for (int s = 0; s < 256; ++s) {
+        if (!lengths[s]) continue;
+        if (lengths[s] > MAX_CODE_LENGTH) {
+            std::cerr << "Error: Huffman code length " << (int)lengths[s] << " exceeds limit." << std::endl;
+            return false;
+        }
+        length_count[lengths[s]]++;
+        kraft += (uint64_t)1 << (MAX_CODE_LENGTH - lengths[s]);
+        if (lengths[s] > max_length) max_length = lengths[s];
+    }
+    if (max_length == 0 || kraft > ((uint64_t)1 << MAX_CODE_LENGTH)) {
+        std::cerr << "Error: Invalid Huffman code lengths in header." << std::endl;
+        return false;
+    }
+
+    assignCanonicalCodes(lengths, first_code, codes);
+    uint32_t index = 0;
+    for (uint32_t len = 1; len <= MAX_CODE_LENGTH; ++len) {
+        first_index[len] = index;
+        for (int s = 0; s < 256; ++s) {
+            if (lengths[s] == len) sorted_symbols[index++] = (uint8_t)s;
+        }
+    }
+
+    for (uint32_t i = 0; i < table.size(); ++i) {
+        TableEntry& entry = table[i];
+        uint64_t bits = (uint64_t)i << (64 - TABLE_BITS);
+        uint32_t consumed = 0;
+        entry.count = 0;
+        while (entry.count < MAX_SYMBOLS_PER_ENTRY && consumed < TABLE_BITS) {
+            uint32_t used = 0;
+            int symbol = decodeSlow(bits << consumed, TABLE_BITS - consumed, used);
+            if (symbol < 0) break;
+            entry.symbols[entry.count++] = (uint8_t)symbol;
+            consumed += used;
+        }
+        entry.bits = (uint8_t)consumed;
+    }
+    return true;
+}
+
+bool HuffmanDecoder::decodeStream(std::istream& in, std::ostream& out) {
+    uint64_t total_bytes;
+    uint8_t lengths[256];
+    if (!in.read(reinterpret_cast<char*>(&total_bytes), sizeof(total_bytes)) ||
+        !in.read(reinterpret_cast<char*>(lengths), 256)) {
+        std::cerr << "Error reading Huffman header." << std::endl;
+        return false;
+    }
+    if (total_bytes == 0) {
+        return true;
+    }
+    if (!buildTables(lengths)) {
+        return false;
+    }
+
+    std::string payload;
+    if (!readStreamContents(in, payload)) {
+        std::cerr << "Error reading Huffman payload." << std::endl;
+        return false;
+    }
+    if (total_bytes > (uint64_t)payload.size() * 8) {
+        std::cerr << "Error: Huffman payload too short for " << total_bytes << " symbols." << std::endl;
+        return false;
+    }
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(payload.data());
+    const size_t size = payload.size();
+    size_t pos = 0;
+    uint64_t buf = 0;
+    uint32_t avail = 0;
+
+    std::string output;
+    output.resize((size_t)total_bytes);
+    uint64_t produced = 0;
+    while (produced < total_bytes) {
+        while (avail <= 56) {
+            uint64_t byte = pos < size ? data[pos] : 0;
+            pos++;
+            buf |= byte << (56 - avail);
+            avail += 8;
+        }
+
+        const TableEntry& entry = table[(size_t)(buf >> (64 - TABLE_BITS))];
+        if (entry.count > 0 && entry.count <= total_bytes - produced) {
+            for (uint32_t k = 0; k < entry.count; ++k) {
+                output[(size_t)produced++] = static_cast<char>(entry.symbols[k]);
+            }
+            buf <<= entry.bits;
+            avail -= entry.bits;
+        } else {
+            uint32_t used = 0;
+            int symbol = decodeSlow(buf, avail, used);
+            if (symbol < 0) {
+                std::cerr << "Error: Invalid Huffman code at symbol " << produced << "." << std::endl;
+                return false;
+            }
+            output[(size_t)produced++] = static_cast<char>(symbol);
+            buf <<= used;
+            avail -= used;
+        }
+    }
+
+    if ((uint64_t)pos * 8 - avail > (uint64_t)size * 8) {
+        std::cerr << "Error: Huffman payload ended before " << total_bytes << " symbols were decoded." << std::endl;
+        return false;
+    }
+
+    out.write(output.data(), output.size());
+    return out.good();
+}
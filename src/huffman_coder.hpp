@@ -0,0 +1,49 @@
+#ifndef HUFFMAN_CODER_HPP
+#define HUFFMAN_CODER_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Canonical Huffman coder for the fastest compression levels. Only the 256
+// code lengths are stored; codes are rebuilt canonically on both sides.
+class HuffmanEncoder {
+private:
+    bool buildCodeLengths(const uint32_t frequency[256], uint8_t lengths[256]);
+
+public:
+    HuffmanEncoder();
+    bool encodeStream(std::istream& in, std::ostream& out);
+};
+
+// Decodes with a TABLE_BITS-wide lookup table whose entries hold every
+// symbol that fits completely in the peeked bits, so short codes come out
+// several at a time. Longer codes fall back to a canonical bit-by-bit walk.
+class HuffmanDecoder {
+private:
+    static const uint32_t TABLE_BITS = 12;
+    static const uint32_t MAX_SYMBOLS_PER_ENTRY = 3;
+
+    struct TableEntry {
+        uint8_t count;
+        uint8_t bits;
+        uint8_t symbols[MAX_SYMBOLS_PER_ENTRY];
+    };
+
+    std::vector<TableEntry> table;
+    uint32_t first_code[17];
+    uint32_t first_index[17];
+    uint32_t length_count[17];
+    uint8_t sorted_symbols[256];
+    uint32_t max_length;
+
+    bool buildTables(const uint8_t lengths[256]);
+    int decodeSlow(uint64_t bits, uint32_t available, uint32_t& used) const;
+
+public:
+    HuffmanDecoder();
+    bool decodeStream(std::istream& in, std::ostream& out);
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "level_codec.hpp"
+#include "constants.hpp"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+LevelEngine getLevelEngine(int level) {
+    if (level <= 3) return ENGINE_HUFFMAN;
+    if (level <= 6) return ENGINE_ARITHMETIC_STATIC;
+    return ENGINE_ARITHMETIC_ADAPTIVE;
+}
+
+const char* getLevelEngineName(int level) {
+    switch (getLevelEngine(level)) {
+        case ENGINE_HUFFMAN: return "huffman";
+        case ENGINE_ARITHMETIC_STATIC: return "arith-o0";
+        case ENGINE_ARITHMETIC_ADAPTIVE: return "arith-o1";
+    }
+    return "unknown";
+}
+
+LevelEncoder::LevelEncoder() {}
+
+bool LevelEncoder::encodeStream(std::istream& in, std::ostream& out, int level) {
+    if (level < MIN_COMPRESSION_LEVEL || level > MAX_COMPRESSION_LEVEL) {
+        std::cerr << "Error: Compression level " << level << " is outside "
+                  << MIN_COMPRESSION_LEVEL << ".." << MAX_COMPRESSION_LEVEL << "." << std::endl;
+        return false;
+    }
+
+    uint8_t level_byte = static_cast<uint8_t>(level);
+    out.write(LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+    out.write(reinterpret_cast<const char*>(&level_byte), sizeof(level_byte));
+
+    switch (getLevelEngine(level)) {
+        case ENGINE_HUFFMAN: return huffman_encoder.encodeStream(in, out);
+        case ENGINE_ARITHMETIC_STATIC: return arithmetic_encoder.encodeStream(in, out);
+        case ENGINE_ARITHMETIC_ADAPTIVE: return arithmetic_encoder.encodeAdaptive(in, out);
+    }
+    return false;
+}
+
+bool LevelEncoder::encode(const std::string& input_filename, const std::string& output_filename, int level) {
+    std::ifstream infile(input_filename, std::ios::binary);
+    if (!infile.is_open()) {
+        std::cerr << "Error opening input file: " << input_filename << std::endl;
+        return false;
+    }
+
+    std::ofstream outfile(output_filename, std::ios::binary);
+    if (!outfile.is_open()) {
+        std::cerr << "Error opening output file: " << output_filename << std::endl;
+        return false;
+    }
+
+    if (!encodeStream(infile, outfile, level)) {
+        outfile.close();
+        std::remove(output_filename.c_str());
+        return false;
+    }
+
+    outfile.close();
+    if (!outfile) {
+        std::cerr << "Error occurred during final write/close of file: " << output_filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+LevelDecoder::LevelDecoder() : last_level(0) {}
+
+bool LevelDecoder::decodeStream(std::istream& in, std::ostream& out) {
+    char magic[sizeof(LEVEL_MAGIC)];
+    uint8_t level_byte;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, LEVEL_MAGIC, sizeof(magic)) != 0 ||
+        !in.read(reinterpret_cast<char*>(&level_byte), sizeof(level_byte))) {
+        std::cerr << "Error: Missing level codestream header." << std::endl;
+        return false;
+    }
+    if (level_byte < MIN_COMPRESSION_LEVEL || level_byte > MAX_COMPRESSION_LEVEL) {
+        std::cerr << "Error: Unsupported compression level " << (int)level_byte << " in header." << std::endl;
+        return false;
+    }
+    last_level = level_byte;
+
+    switch (getLevelEngine(level_byte)) {
+        case ENGINE_HUFFMAN: return huffman_decoder.decodeStream(in, out);
+        case ENGINE_ARITHMETIC_STATIC: return arithmetic_decoder.decodeStream(in, out);
+        case ENGINE_ARITHMETIC_ADAPTIVE: return arithmetic_decoder.decodeAdaptive(in, out);
+    }
+    return false;
+}
+
+bool LevelDecoder::decode(const std::string& input_filename, const std::string& output_filename) {
+    std::ifstream infile(input_filename, std::ios::binary);
+    if (!infile.is_open()) {
+        std::cerr << "Error opening input file: " << input_filename << std::endl;
+        return false;
+    }
+
+    std::ofstream outfile(output_filename, std::ios::binary);
+    if (!outfile.is_open()) {
+        std::cerr << "Error opening output file: " << output_filename << std::endl;
+        return false;
+    }
+
+    if (!decodeStream(infile, outfile)) {
+        std::cerr << "Failed to decode codestream: " << input_filename << std::endl;
+        outfile.close();
+        std::remove(output_filename.c_str());
+        return false;
+    }
+
+    outfile.close();
+    if (!outfile) {
+        std::cerr << "Error occurred during final write/close of file: " << output_filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int LevelDecoder::getLevel() const {
+    return last_level;
+}
+
+bool isLevelCodestream(const std::string& filename) {
+    std::ifstream infile(filename, std::ios::binary);
+    char magic[sizeof(LEVEL_MAGIC)];
+    if (!infile.is_open() || !infile.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return std::memcmp(magic, LEVEL_MAGIC, sizeof(magic)) == 0;
+}
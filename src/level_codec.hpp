@@ -0,0 +1,50 @@
+#ifndef LEVEL_CODEC_HPP
+#define LEVEL_CODEC_HPP
+
+#include <string>
+#include <iostream>
+#include "arithmetic_coder.hpp"
+#include "huffman_coder.hpp"
+
+// Level-tagged codestream: LEVEL_MAGIC, one level byte, then the engine payload.
+//   levels 1-3: canonical Huffman, table-driven multi-symbol decode
+//   levels 4-6: static order-0 arithmetic coding (the untagged codestream format)
+//   levels 7-9: adaptive order-1 arithmetic coding
+// The engines have no per-level settings, so every level in a tier aliases
+// to the same engine; the requested level is still written to the header.
+enum LevelEngine {
+    ENGINE_HUFFMAN,
+    ENGINE_ARITHMETIC_STATIC,
+    ENGINE_ARITHMETIC_ADAPTIVE
+};
+
+LevelEngine getLevelEngine(int level);
+const char* getLevelEngineName(int level);
+
+class LevelEncoder {
+private:
+    ArithmeticEncoder arithmetic_encoder;
+    HuffmanEncoder huffman_encoder;
+
+public:
+    LevelEncoder();
+    bool encode(const std::string& input_filename, const std::string& output_filename, int level);
+    bool encodeStream(std::istream& in, std::ostream& out, int level);
+};
+
+class LevelDecoder {
+private:
+    ArithmeticDecoder arithmetic_decoder;
+    HuffmanDecoder huffman_decoder;
+    int last_level;
+
+public:
+    LevelDecoder();
+    bool decode(const std::string& input_filename, const std::string& output_filename);
+    bool decodeStream(std::istream& in, std::ostream& out);
+    int getLevel() const;
+};
+
+bool isLevelCodestream(const std::string& filename);
+
+#endif
@@ -2,15 +2,47 @@
 #include <iomanip>
 #include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <vector>
+#include <string>
+#include <thread>
+#include <cctype>
+#include <cerrno>
 #include "arithmetic_coder.hpp"
+#include "near_lossless.hpp"
+#include "coder_server.hpp"
+#include "archive.hpp"
+#include "level_codec.hpp"
+#include <sstream>
 #include "utils.hpp"
+#include "constants.hpp"
+
+const unsigned long MAX_SERVER_WORKERS = 256;
+
+// Parses a decimal command-line number in [0, max_value]. strtoul skips
+// whitespace and wraps a leading '-', so the text must start with a digit.
+static bool parseUnsignedArg(const char* text, unsigned long max_value, unsigned long& value) {
+    if (!std::isdigit(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoul(text, &end, 10);
+    return end != text && *end == '\0' && errno != ERANGE && value <= max_value;
+}
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
         std::cerr << "Usage:" << std::endl;
-        std::cerr << "  " << argv[0] << " encode <input_file> <output.codestream>" << std::endl;
+        std::cerr << "  " << argv[0] << " encode [-1..-9] <input_file> <output.codestream>" << std::endl;
         std::cerr << "  " << argv[0] << " decode <input.codestream> <output_file>" << std::endl;
+        std::cerr << "  " << argv[0] << " encode_nl <input.pgm> <output.codestream> <max_error>" << std::endl;
+        std::cerr << "  " << argv[0] << " serve <socket_path> [worker_threads]" << std::endl;
+        std::cerr << "  " << argv[0] << " client <socket_path> <command> [args...]" << std::endl;
+        std::cerr << "  " << argv[0] << " archive_create <output.acar> [--shared-model] <input_file>..." << std::endl;
+        std::cerr << "  " << argv[0] << " archive_list <input.acar>" << std::endl;
+        std::cerr << "  " << argv[0] << " archive_extract <input.acar> <output_dir> [member...]" << std::endl;
+        std::cerr << "  " << argv[0] << " benchmark [input_file...]" << std::endl;
         std::cerr << "  " << argv[0] << " encode_all" << std::endl;
         std::cerr << "  " << argv[0] << " decode_all" << std::endl;
         return 1;
@@ -20,18 +52,37 @@ int main(int argc, char* argv[]) {
     auto global_start_time = std::chrono::high_resolution_clock::now();
 
     if (mode == "encode") {
-        if (argc < 4) {
-            std::cerr << "Usage for encoding: " << argv[0] << " encode <input_file> <output.codestream>" << std::endl;
+        int level = 0;
+        int arg_index = 2;
+        if (argc > 2 && argv[2][0] == '-' && std::isdigit(static_cast<unsigned char>(argv[2][1])) && argv[2][2] == '\0') {
+            level = argv[2][1] - '0';
+            arg_index = 3;
+            if (level < MIN_COMPRESSION_LEVEL) {
+                std::cerr << "Invalid compression level: " << argv[2] << std::endl;
+                return 1;
+            }
+        }
+        if (argc < arg_index + 2) {
+            std::cerr << "Usage for encoding: " << argv[0] << " encode [-1..-9] <input_file> <output.codestream>" << std::endl;
             return 1;
         }
-        std::string input_file = argv[2];
-        std::string output_file = argv[3];
+        std::string input_file = argv[arg_index];
+        std::string output_file = argv[arg_index + 1];
 
-        std::cout << "Encoding " << input_file << " to " << output_file << "..." << std::endl;
+        std::cout << "Encoding " << input_file << " to " << output_file;
+        if (level > 0) std::cout << " (level " << level << ", " << getLevelEngineName(level) << ")";
+        std::cout << "..." << std::endl;
         auto start_time = std::chrono::high_resolution_clock::now();
 
-        ArithmeticEncoder encoder;
-        if (!encoder.encode(input_file, output_file)) {
+        bool encoded;
+        if (level > 0) {
+            LevelEncoder encoder;
+            encoded = encoder.encode(input_file, output_file, level);
+        } else {
+            ArithmeticEncoder encoder;
+            encoded = encoder.encode(input_file, output_file);
+        }
+        if (!encoded) {
             std::cerr << "Failed to encode file." << std::endl;
             std::remove(output_file.c_str());
             return 1;
@@ -61,8 +112,19 @@ int main(int argc, char* argv[]) {
         std::cout << "Decoding " << input_file << " to " << output_file << "..." << std::endl;
         auto start_time = std::chrono::high_resolution_clock::now();
 
-        ArithmeticDecoder decoder;
-        if (!decoder.decode(input_file, output_file)) {
+        bool decoded;
+        if (isNearLosslessCodestream(input_file)) {
+            NearLosslessDecoder decoder;
+            decoded = decoder.decode(input_file, output_file);
+        } else if (isLevelCodestream(input_file)) {
+            LevelDecoder decoder;
+            decoded = decoder.decode(input_file, output_file);
+            if (decoded) std::cout << "Codestream level:  " << decoder.getLevel() << " (" << getLevelEngineName(decoder.getLevel()) << ")" << std::endl;
+        } else {
+            ArithmeticDecoder decoder;
+            decoded = decoder.decode(input_file, output_file);
+        }
+        if (!decoded) {
             std::cerr << "Failed to decode file." << std::endl;
             std::remove(output_file.c_str());
             return 1;
@@ -77,6 +139,316 @@ int main(int argc, char* argv[]) {
         if (decoded_size >= 0) std::cout << "Decoded size:      " << decoded_size << " bytes" << std::endl;
         std::cout << "Decoding time:     " << std::fixed << std::setprecision(3) << duration.count() << " seconds" << std::endl;
 
+    } else if (mode == "encode_nl") {
+        if (argc < 5) {
+            std::cerr << "Usage for near-lossless encoding: " << argv[0] << " encode_nl <input.pgm> <output.codestream> <max_error>" << std::endl;
+            return 1;
+        }
+        std::string input_file = argv[2];
+        std::string output_file = argv[3];
+        unsigned long max_error;
+        if (!parseUnsignedArg(argv[4], MAX_NEAR_LOSSLESS_ERROR, max_error)) {
+            std::cerr << "Invalid maximum error: " << argv[4] << " (expected 0-"
+                      << MAX_NEAR_LOSSLESS_ERROR << ")" << std::endl;
+            return 1;
+        }
+
+        std::cout << "Encoding " << input_file << " to " << output_file
+                  << " (near-lossless, max error " << max_error << ")..." << std::endl;
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        NearLosslessEncoder encoder;
+        if (!encoder.encode(input_file, output_file, static_cast<uint32_t>(max_error))) {
+            std::cerr << "Failed to encode file." << std::endl;
+            std::remove(output_file.c_str());
+            return 1;
+        }
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> duration = end_time - start_time;
+
+        std::streamsize orig_size = getFileSize(input_file);
+        std::streamsize comp_size = getFileSize(output_file);
+        double ratio = calculateCompressionRatio(orig_size, comp_size);
+
+        std::cout << "Successfully encoded file." << std::endl;
+        if (orig_size >= 0) std::cout << "Original size:     " << orig_size << " bytes" << std::endl;
+        if (comp_size >= 0) std::cout << "Compressed size:   " << comp_size << " bytes" << std::endl;
+        if (ratio > 0.0) std::cout << "Compression ratio: " << std::fixed << std::setprecision(2) << ratio << ":1" << std::endl;
+        std::cout << "Max pixel error:   " << encoder.getMaxError() << std::endl;
+        std::cout << "PSNR:              " << std::fixed << std::setprecision(2) << encoder.getPSNR() << " dB" << std::endl;
+        std::cout << "Encoding time:     " << std::fixed << std::setprecision(3) << duration.count() << " seconds" << std::endl;
+
+    } else if (mode == "serve") {
+        if (argc < 3) {
+            std::cerr << "Usage for serving: " << argv[0] << " serve <socket_path> [worker_threads]" << std::endl;
+            return 1;
+        }
+        unsigned workers = std::thread::hardware_concurrency();
+        if (argc >= 4) {
+            unsigned long requested;
+            if (!parseUnsignedArg(argv[3], MAX_SERVER_WORKERS, requested) || requested == 0) {
+                std::cerr << "Invalid worker count: " << argv[3] << " (expected 1-"
+                          << MAX_SERVER_WORKERS << ")" << std::endl;
+                return 1;
+            }
+            workers = static_cast<unsigned>(requested);
+        }
+
+        CoderServer server(argv[2], workers);
+        if (!server.run()) {
+            return 1;
+        }
+
+    } else if (mode == "client") {
+        if (argc < 4) {
+            std::cerr << "Usage for client: " << argv[0] << " client <socket_path> <command> [args...]" << std::endl;
+            std::cerr << "  Server-side paths: encode|decode <input> <output>, verify <codestream> <original>" << std::endl;
+            std::cerr << "  Inline payloads:   encode_inline [-1..-9] <local_input> <local_output>," << std::endl;
+            std::cerr << "                     decode_inline <local_input> <local_output>" << std::endl;
+            std::cerr << "  Control:           stats, shutdown" << std::endl;
+            return 1;
+        }
+        std::string command = argv[3];
+        std::string command_line;
+        std::string payload;
+        std::string output_file;
+
+        if ((command == "encode" || command == "decode" || command == "verify") && argc == 6) {
+            for (char& c : command) c = static_cast<char>(std::toupper(c));
+            command_line = command + "\t" + argv[4] + "\t" + argv[5];
+        } else if ((command == "encode_inline" && (argc == 6 || argc == 7)) ||
+                   (command == "decode_inline" && argc == 6)) {
+            int arg_index = 4;
+            std::string level_field;
+            if (argc == 7) {
+                unsigned long level;
+                if (argv[4][0] != '-' || !parseUnsignedArg(argv[4] + 1, MAX_COMPRESSION_LEVEL, level) ||
+                    level < MIN_COMPRESSION_LEVEL) {
+                    std::cerr << "Invalid compression level: " << argv[4] << std::endl;
+                    return 1;
+                }
+                level_field = "\t" + std::to_string(level);
+                arg_index = 5;
+            }
+            if (!readFileContents(argv[arg_index], payload)) {
+                std::cerr << "Error opening input file: " << argv[arg_index] << std::endl;
+                return 1;
+            }
+            command_line = std::string(command == "encode_inline" ? "ENCODE_INLINE" : "DECODE_INLINE") +
+                           "\t" + std::to_string(payload.size()) + level_field;
+            output_file = argv[arg_index + 1];
+        } else if ((command == "stats" || command == "shutdown") && argc == 4) {
+            command_line = command == "stats" ? "STATS" : "SHUTDOWN";
+        } else {
+            std::cerr << "Unknown or malformed client command: " << command << std::endl;
+            return 1;
+        }
+
+        CoderClient client(argv[2]);
+        bool server_ok = false;
+        std::string response;
+        if (!client.request(command_line, payload, server_ok, response)) {
+            return 1;
+        }
+        if (!server_ok) {
+            std::cerr << "Server error: " << response << std::endl;
+            return 1;
+        }
+        if (!output_file.empty()) {
+            if (!writeFileContents(output_file, response)) {
+                std::cerr << "Error writing output file: " << output_file << std::endl;
+                return 1;
+            }
+            std::cout << "Wrote " << response.size() << " bytes to " << output_file << std::endl;
+        } else {
+            std::cout << response << (response.empty() || response.back() == '\n' ? "" : "\n");
+        }
+
+    } else if (mode == "archive_create") {
+        if (argc < 4) {
+            std::cerr << "Usage for archiving: " << argv[0] << " archive_create <output.acar> [--shared-model] <input_file>..." << std::endl;
+            return 1;
+        }
+        std::string archive_file = argv[2];
+        bool shared_model = false;
+        std::vector<std::string> members;
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--shared-model") {
+                shared_model = true;
+            } else {
+                members.push_back(arg);
+            }
+        }
+
+        std::cout << "Creating archive " << archive_file << " with " << members.size() << " member(s)"
+                  << (shared_model ? " and a shared model" : "") << "..." << std::endl;
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        ArchiveWriter writer;
+        if (!writer.create(archive_file, members, shared_model)) {
+            std::cerr << "Failed to create archive." << std::endl;
+            return 1;
+        }
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> duration = end_time - start_time;
+
+        std::streamsize orig_size = 0;
+        for (const auto& member : members) orig_size += getFileSize(member);
+        std::streamsize comp_size = getFileSize(archive_file);
+        double ratio = calculateCompressionRatio(orig_size, comp_size);
+
+        std::cout << "Successfully created archive." << std::endl;
+        std::cout << "Original size:     " << orig_size << " bytes" << std::endl;
+        if (comp_size >= 0) std::cout << "Archive size:      " << comp_size << " bytes" << std::endl;
+        if (ratio > 0.0) std::cout << "Compression ratio: " << std::fixed << std::setprecision(2) << ratio << ":1" << std::endl;
+        std::cout << "Archiving time:    " << std::fixed << std::setprecision(3) << duration.count() << " seconds" << std::endl;
+
+    } else if (mode == "archive_list") {
+        if (argc < 3) {
+            std::cerr << "Usage for listing: " << argv[0] << " archive_list <input.acar>" << std::endl;
+            return 1;
+        }
+        ArchiveReader reader;
+        if (!reader.open(argv[2])) {
+            return 1;
+        }
+
+        std::cout << "Archive " << argv[2] << ": " << reader.getMemberCount() << " member(s)"
+                  << (reader.hasSharedModel() ? ", shared model" : "") << std::endl;
+        std::cout << "------------------------------------------------------------------" << std::endl;
+        std::cout << std::left << std::setw(28) << "Member"
+                  << std::right << std::setw(15) << "Original Size"
+                  << std::setw(15) << "Comp. Size" << std::endl;
+        std::cout << "------------------------------------------------------------------" << std::endl;
+        for (uint32_t i = 0; i < reader.getMemberCount(); ++i) {
+            ArchiveMemberInfo info;
+            if (!reader.getMemberInfo(i, info)) {
+                std::cerr << "Error: Archive entry " << i << " is out of bounds or has an invalid name." << std::endl;
+                return 1;
+            }
+            std::cout << std::left << std::setw(28) << info.name
+                      << std::right << std::setw(15) << info.original_size
+                      << std::setw(15) << info.data_size << std::endl;
+        }
+        std::cout << "------------------------------------------------------------------" << std::endl;
+
+    } else if (mode == "archive_extract") {
+        if (argc < 4) {
+            std::cerr << "Usage for extraction: " << argv[0] << " archive_extract <input.acar> <output_dir> [member...]" << std::endl;
+            return 1;
+        }
+        std::string output_dir = argv[3];
+        ArchiveReader reader;
+        if (!reader.open(argv[2])) {
+            return 1;
+        }
+
+        std::vector<uint32_t> indices;
+        if (argc == 4) {
+            for (uint32_t i = 0; i < reader.getMemberCount(); ++i) indices.push_back(i);
+        } else {
+            for (int i = 4; i < argc; ++i) {
+                int64_t index = reader.findMember(argv[i]);
+                if (index < 0) {
+                    std::cerr << "Error: Member not found in archive: " << argv[i] << std::endl;
+                    return 1;
+                }
+                indices.push_back(static_cast<uint32_t>(index));
+            }
+        }
+
+        std::cout << "Extracting " << indices.size() << " member(s) to " << output_dir << "..." << std::endl;
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        if (!reader.extractMembers(indices, output_dir, std::thread::hardware_concurrency())) {
+            std::cerr << "Failed to extract archive." << std::endl;
+            return 1;
+        }
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> duration = end_time - start_time;
+        std::cout << "Successfully extracted " << indices.size() << " member(s)." << std::endl;
+        std::cout << "Extraction time:   " << std::fixed << std::setprecision(3) << duration.count() << " seconds" << std::endl;
+
+    } else if (mode == "benchmark") {
+        std::vector<std::string> inputs;
+        for (int i = 2; i < argc; ++i) inputs.push_back(argv[i]);
+        if (inputs.empty()) {
+            inputs.push_back("input/lena_ascii.pgm");
+            inputs.push_back("input/baboon_ascii.pgm");
+            inputs.push_back("input/quadrado_ascii.pgm");
+        }
+
+        std::vector<std::string> contents(inputs.size());
+        uint64_t total_input = 0;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            if (!readFileContents(inputs[i], contents[i])) {
+                std::cerr << "Error reading " << inputs[i] << std::endl;
+                return 1;
+            }
+            total_input += contents[i].size();
+        }
+
+        std::vector<double> ratios, encode_speeds, decode_speeds;
+        LevelEncoder encoder;
+        LevelDecoder decoder;
+        // Levels in a tier produce identical output, so only one point per engine.
+        for (int level : ENGINE_LEVELS) {
+            uint64_t total_output = 0;
+            double encode_seconds = 0.0, decode_seconds = 0.0;
+            for (const auto& original : contents) {
+                std::istringstream in(original);
+                std::ostringstream coded;
+                auto start_time = std::chrono::high_resolution_clock::now();
+                bool ok = encoder.encodeStream(in, coded, level);
+                auto mid_time = std::chrono::high_resolution_clock::now();
+
+                std::istringstream coded_in(coded.str());
+                std::ostringstream decoded;
+                ok = ok && decoder.decodeStream(coded_in, decoded);
+                auto end_time = std::chrono::high_resolution_clock::now();
+                if (!ok || decoded.str() != original) {
+                    std::cerr << "Benchmark round trip failed at level " << level << "." << std::endl;
+                    return 1;
+                }
+
+                encode_seconds += std::chrono::duration<double>(mid_time - start_time).count();
+                decode_seconds += std::chrono::duration<double>(end_time - mid_time).count();
+                total_output += coded.str().size();
+            }
+            ratios.push_back(calculateCompressionRatio(total_input, total_output));
+            encode_speeds.push_back(total_input / 1e6 / encode_seconds);
+            decode_speeds.push_back(total_input / 1e6 / decode_seconds);
+        }
+
+        double max_decode_speed = 0.0, max_ratio = 0.0;
+        for (size_t i = 0; i < ratios.size(); ++i) {
+            if (decode_speeds[i] > max_decode_speed) max_decode_speed = decode_speeds[i];
+            if (ratios[i] > max_ratio) max_ratio = ratios[i];
+        }
+
+        const int bar_width = 20;
+        std::cout << "Speed/ratio curve over " << inputs.size() << " file(s), " << total_input << " bytes" << std::endl;
+        std::cout << "-----------------------------------------------------------------------------------------" << std::endl;
+        std::cout << std::left << std::setw(7) << "Level" << std::setw(10) << "Engine"
+                  << std::right << std::setw(8) << "Ratio" << std::setw(11) << "Enc MB/s" << std::setw(11) << "Dec MB/s"
+                  << "  " << std::left << std::setw(bar_width + 1) << "Ratio" << "Decode speed" << std::endl;
+        std::cout << "-----------------------------------------------------------------------------------------" << std::endl;
+        for (size_t i = 0; i < ratios.size(); ++i) {
+            int level = ENGINE_LEVELS[i];
+            int ratio_bar = (int)(bar_width * ratios[i] / max_ratio + 0.5);
+            int speed_bar = (int)(bar_width * decode_speeds[i] / max_decode_speed + 0.5);
+            std::cout << std::left << std::setw(7) << ("-" + std::to_string(level)) << std::setw(10) << getLevelEngineName(level)
+                      << std::right << std::fixed << std::setprecision(2) << std::setw(6) << ratios[i] << ":1"
+                      << std::setw(11) << encode_speeds[i] << std::setw(11) << decode_speeds[i] << "  "
+                      << std::left << std::setw(bar_width + 1) << std::string(ratio_bar, '#')
+                      << std::string(speed_bar, '=') << std::endl;
+        }
+        std::cout << "-----------------------------------------------------------------------------------------" << std::endl;
+
     } else if (mode == "encode_all") {
         const std::vector<std::pair<std::string, std::string>> files = {
             {"input/lena_ascii.pgm", "lena_ascii.codestream"},
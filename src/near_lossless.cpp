@@ -0,0 +1,247 @@
+#include "near_lossless.hpp"
+#include "arithmetic_coder.hpp"
+#include "constants.hpp"
+#include "utils.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+namespace {
+
+struct QuantizerParams {
+    int32_t near;
+    int32_t maxval;
+    int32_t step;
+    int32_t range;
+
+    QuantizerParams(uint32_t max_error, uint32_t image_maxval)
+        : near((int32_t)max_error), maxval((int32_t)image_maxval), step(2 * (int32_t)max_error + 1),
+          range(((int32_t)image_maxval + 2 * (int32_t)max_error) / (2 * (int32_t)max_error + 1) + 1) {}
+};
+
+// LOCO-I median edge detector over already reconstructed neighbours.
+int32_t predictSample(const std::vector<uint8_t>& recon, uint32_t width, uint32_t x, uint32_t y, int32_t maxval) {
+    if (x == 0 && y == 0) return (maxval + 1) / 2;
+    size_t pos = (size_t)y * width + x;
+    if (y == 0) return recon[pos - 1];
+    if (x == 0) return recon[pos - width];
+
+    int32_t a = recon[pos - 1];
+    int32_t b = recon[pos - width];
+    int32_t c = recon[pos - width - 1];
+    int32_t mn = a < b ? a : b;
+    int32_t mx = a < b ? b : a;
+    if (c >= mx) return mn;
+    if (c <= mn) return mx;
+    return a + b - c;
+}
+
+uint8_t quantizeResidual(int32_t error, const QuantizerParams& q) {
+    int32_t index = error >= 0 ? (error + q.near) / q.step : -((q.near - error) / q.step);
+    index %= q.range;
+    if (index < 0) index += q.range;
+    return static_cast<uint8_t>(index);
+}
+
+// Shared by encoder and decoder so both track identical reconstructed values.
+uint8_t reconstructSample(int32_t prediction, uint8_t symbol, const QuantizerParams& q) {
+    int32_t index = symbol;
+    if (index > (q.range - 1) / 2) index -= q.range;
+
+    int32_t value = prediction + index * q.step;
+    int32_t wrap = q.range * q.step;
+    if (value < -q.near) {
+        value += wrap;
+    } else if (value > q.maxval + q.near) {
+        value -= wrap;
+    }
+    if (value < 0) value = 0;
+    if (value > q.maxval) value = q.maxval;
+    return static_cast<uint8_t>(value);
+}
+
+}
+
+NearLosslessEncoder::NearLosslessEncoder() : reported_max_error(0), reported_psnr(0.0) {}
+
+bool NearLosslessEncoder::writeHeader(std::ostream& out, const PgmImage& image, uint32_t max_error) {
+    uint16_t maxval = static_cast<uint16_t>(image.maxval);
+    uint8_t near = static_cast<uint8_t>(max_error);
+
+    out.write(NEAR_LOSSLESS_MAGIC, sizeof(NEAR_LOSSLESS_MAGIC));
+    out.write(reinterpret_cast<const char*>(&image.width), sizeof(image.width));
+    out.write(reinterpret_cast<const char*>(&image.height), sizeof(image.height));
+    out.write(reinterpret_cast<const char*>(&maxval), sizeof(maxval));
+    out.write(reinterpret_cast<const char*>(&near), sizeof(near));
+    return out.good();
+}
+
+bool NearLosslessEncoder::encode(const std::string& input_filename, const std::string& output_filename, uint32_t max_error) {
+    if (max_error > MAX_NEAR_LOSSLESS_ERROR) {
+        std::cerr << "Error: Maximum error " << max_error << " exceeds supported limit of "
+                  << MAX_NEAR_LOSSLESS_ERROR << "." << std::endl;
+        return false;
+    }
+
+    PgmImage image;
+    if (!readPgm(input_filename, image)) {
+        return false;
+    }
+
+    QuantizerParams params(max_error, image.maxval);
+    std::vector<uint8_t> recon(image.pixels.size(), 0);
+    std::string residuals(image.pixels.size(), '\0');
+
+    uint64_t squared_error_sum = 0;
+    reported_max_error = 0;
+    for (uint32_t y = 0; y < image.height; ++y) {
+        for (uint32_t x = 0; x < image.width; ++x) {
+            size_t pos = (size_t)y * image.width + x;
+            int32_t prediction = predictSample(recon, image.width, x, y, params.maxval);
+            uint8_t symbol = quantizeResidual((int32_t)image.pixels[pos] - prediction, params);
+            residuals[pos] = static_cast<char>(symbol);
+            recon[pos] = reconstructSample(prediction, symbol, params);
+
+            uint32_t error = (uint32_t)std::abs((int32_t)image.pixels[pos] - (int32_t)recon[pos]);
+            if (error > max_error) {
+                std::cerr << "Internal Error: Reconstruction error " << error << " at pixel " << pos
+                          << " exceeds bound " << max_error << "." << std::endl;
+                return false;
+            }
+            if (error > reported_max_error) reported_max_error = error;
+            squared_error_sum += (uint64_t)error * error;
+        }
+    }
+    reported_psnr = calculatePSNR((double)squared_error_sum / image.pixels.size(), image.maxval);
+
+    std::ofstream outfile(output_filename, std::ios::binary);
+    if (!outfile.is_open()) {
+        std::cerr << "Error opening output file: " << output_filename << std::endl;
+        return false;
+    }
+
+    if (!writeHeader(outfile, image, max_error)) {
+        std::cerr << "Error writing header to output file: " << output_filename << std::endl;
+        outfile.close();
+        std::remove(output_filename.c_str());
+        return false;
+    }
+
+    std::istringstream residual_stream(residuals);
+    ArithmeticEncoder encoder;
+    if (!encoder.encodeStream(residual_stream, outfile)) {
+        outfile.close();
+        std::remove(output_filename.c_str());
+        return false;
+    }
+
+    outfile.close();
+    if (!outfile) {
+        std::cerr << "Error occurred during final write/close of file: " << output_filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+uint32_t NearLosslessEncoder::getMaxError() const {
+    return reported_max_error;
+}
+
+double NearLosslessEncoder::getPSNR() const {
+    return reported_psnr;
+}
+
+NearLosslessDecoder::NearLosslessDecoder() {}
+
+bool NearLosslessDecoder::readHeader(std::istream& in, PgmImage& image, uint32_t& max_error) {
+    char magic[sizeof(NEAR_LOSSLESS_MAGIC)];
+    uint16_t maxval;
+    uint8_t near;
+
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, NEAR_LOSSLESS_MAGIC, sizeof(magic)) != 0) {
+        std::cerr << "Error: Missing near-lossless codestream magic." << std::endl;
+        return false;
+    }
+    if (!in.read(reinterpret_cast<char*>(&image.width), sizeof(image.width)) ||
+        !in.read(reinterpret_cast<char*>(&image.height), sizeof(image.height)) ||
+        !in.read(reinterpret_cast<char*>(&maxval), sizeof(maxval)) ||
+        !in.read(reinterpret_cast<char*>(&near), sizeof(near))) {
+        std::cerr << "Error reading near-lossless image header." << std::endl;
+        return false;
+    }
+    if (image.width == 0 || image.height == 0 || maxval == 0 || maxval > 255 || near > MAX_NEAR_LOSSLESS_ERROR) {
+        std::cerr << "Error: Invalid near-lossless image header." << std::endl;
+        return false;
+    }
+
+    image.maxval = maxval;
+    max_error = near;
+    return true;
+}
+
+bool NearLosslessDecoder::decode(const std::string& input_filename, const std::string& output_filename) {
+    std::ifstream infile(input_filename, std::ios::binary);
+    if (!infile.is_open()) {
+        std::cerr << "Error opening input file: " << input_filename << std::endl;
+        return false;
+    }
+
+    PgmImage image;
+    if (!decodeImage(infile, image)) {
+        std::cerr << "Failed to decode near-lossless codestream: " << input_filename << std::endl;
+        return false;
+    }
+    infile.close();
+
+    return writePgm(output_filename, image);
+}
+
+bool NearLosslessDecoder::decodeStream(std::istream& in, std::ostream& out) {
+    PgmImage image;
+    return decodeImage(in, image) && writePgm(out, image);
+}
+
+bool NearLosslessDecoder::decodeImage(std::istream& in, PgmImage& image) {
+    uint32_t max_error;
+    if (!readHeader(in, image, max_error)) {
+        std::cerr << "Failed to read or validate near-lossless header." << std::endl;
+        return false;
+    }
+
+    std::ostringstream residual_stream;
+    ArithmeticDecoder decoder;
+    if (!decoder.decodeStream(in, residual_stream)) {
+        std::cerr << "Failed to decode near-lossless residuals." << std::endl;
+        return false;
+    }
+
+    const std::string residuals = residual_stream.str();
+    uint64_t pixel_count = (uint64_t)image.width * image.height;
+    if (residuals.size() != pixel_count) {
+        std::cerr << "Error: Decoded " << residuals.size() << " residuals, but image has " << pixel_count << " pixels." << std::endl;
+        return false;
+    }
+
+    QuantizerParams params(max_error, image.maxval);
+    image.pixels.assign(pixel_count, 0);
+    for (uint32_t y = 0; y < image.height; ++y) {
+        for (uint32_t x = 0; x < image.width; ++x) {
+            size_t pos = (size_t)y * image.width + x;
+            int32_t prediction = predictSample(image.pixels, image.width, x, y, params.maxval);
+            image.pixels[pos] = reconstructSample(prediction, static_cast<uint8_t>(residuals[pos]), params);
+        }
+    }
+    return true;
+}
+
+bool isNearLosslessCodestream(const std::string& filename) {
+    std::ifstream infile(filename, std::ios::binary);
+    char magic[sizeof(NEAR_LOSSLESS_MAGIC)];
+    if (!infile.is_open() || !infile.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return std::memcmp(magic, NEAR_LOSSLESS_MAGIC, sizeof(magic)) == 0;
+}
@@ -0,0 +1,41 @@
+#ifndef NEAR_LOSSLESS_HPP
+#define NEAR_LOSSLESS_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "pgm_image.hpp"
+
+// Predictive PGM coder: MED prediction on reconstructed pixels, residuals
+// quantized to a bin width of (2 * max_error + 1) and entropy coded with the
+// arithmetic coder. Every reconstructed pixel is within max_error of the input.
+class NearLosslessEncoder {
+private:
+    uint32_t reported_max_error;
+    double reported_psnr;
+
+    bool writeHeader(std::ostream& out, const PgmImage& image, uint32_t max_error);
+
+public:
+    NearLosslessEncoder();
+    bool encode(const std::string& input_filename, const std::string& output_filename, uint32_t max_error);
+
+    uint32_t getMaxError() const;
+    double getPSNR() const;
+};
+
+class NearLosslessDecoder {
+private:
+    bool readHeader(std::istream& in, PgmImage& image, uint32_t& max_error);
+    bool decodeImage(std::istream& in, PgmImage& image);
+
+public:
+    NearLosslessDecoder();
+    bool decode(const std::string& input_filename, const std::string& output_filename);
+    // Writes the reconstructed image to `out` as a P2 PGM.
+    bool decodeStream(std::istream& in, std::ostream& out);
+};
+
+bool isNearLosslessCodestream(const std::string& filename);
+
+#endif
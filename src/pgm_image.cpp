@@ -0,0 +1,111 @@
+#include "pgm_image.hpp"
+#include <iostream>
+#include <fstream>
+#include <limits>
+#include <cstdio>
+
+static bool readPgmToken(std::istream& in, uint32_t& value) {
+    in >> std::ws;
+    while (in.peek() == '#') {
+        in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        in >> std::ws;
+    }
+    return static_cast<bool>(in >> value);
+}
+
+bool readPgm(const std::string& filename, PgmImage& image) {
+    std::ifstream infile(filename, std::ios::binary);
+    if (!infile.is_open()) {
+        std::cerr << "Error opening input file: " << filename << std::endl;
+        return false;
+    }
+
+    std::string magic;
+    if (!(infile >> magic) || (magic != "P2" && magic != "P5")) {
+        std::cerr << "Error: " << filename << " is not a PGM (P2/P5) image." << std::endl;
+        return false;
+    }
+
+    if (!readPgmToken(infile, image.width) ||
+        !readPgmToken(infile, image.height) ||
+        !readPgmToken(infile, image.maxval)) {
+        std::cerr << "Error reading PGM header from: " << filename << std::endl;
+        return false;
+    }
+    if (image.width == 0 || image.height == 0) {
+        std::cerr << "Error: PGM image has zero width or height." << std::endl;
+        return false;
+    }
+    if (image.maxval == 0 || image.maxval > 255) {
+        std::cerr << "Error: Unsupported PGM maxval " << image.maxval << " (only 8-bit images are supported)." << std::endl;
+        return false;
+    }
+
+    // The header is untrusted: only allocate for pixels the file really holds.
+    uint64_t pixel_count = (uint64_t)image.width * image.height;
+    image.pixels.clear();
+
+    if (magic == "P5") {
+        infile.get();
+        std::streampos data_start = infile.tellg();
+        infile.seekg(0, std::ios::end);
+        std::streamoff available = infile.tellg() - data_start;
+        infile.seekg(data_start);
+        if (data_start < 0 || available < 0 || (uint64_t)available < pixel_count) {
+            std::cerr << "Error: Premature EOF in PGM pixel data." << std::endl;
+            return false;
+        }
+        image.pixels.resize((size_t)pixel_count);
+        if (!infile.read(reinterpret_cast<char*>(image.pixels.data()), pixel_count)) {
+            std::cerr << "Error: Premature EOF in PGM pixel data." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    for (uint64_t i = 0; i < pixel_count; ++i) {
+        uint32_t sample;
+        if (!readPgmToken(infile, sample)) {
+            std::cerr << "Error reading PGM sample " << i << " from: " << filename << std::endl;
+            return false;
+        }
+        if (sample > image.maxval) {
+            std::cerr << "Error: PGM sample " << sample << " exceeds maxval " << image.maxval << "." << std::endl;
+            return false;
+        }
+        image.pixels.push_back(static_cast<uint8_t>(sample));
+    }
+    return true;
+}
+
+bool writePgm(const std::string& filename, const PgmImage& image) {
+    std::ofstream outfile(filename, std::ios::binary);
+    if (!outfile.is_open()) {
+        std::cerr << "Error opening output file: " << filename << std::endl;
+        return false;
+    }
+
+    writePgm(outfile, image);
+
+    outfile.close();
+    if (!outfile) {
+        std::cerr << "Error occurred during final write/close of file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool writePgm(std::ostream& out, const PgmImage& image) {
+    out << "P2\n" << image.width << " " << image.height << "\n" << image.maxval << "\n";
+
+    const uint32_t samples_per_line = 17;
+    char field[8];
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        std::snprintf(field, sizeof(field), "%3u ", (unsigned)image.pixels[i]);
+        out << field;
+        if ((i + 1) % samples_per_line == 0 || i + 1 == image.pixels.size()) {
+            out << '\n';
+        }
+    }
+    return out.good();
+}
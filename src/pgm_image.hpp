@@ -0,0 +1,22 @@
+#ifndef PGM_IMAGE_HPP
+#define PGM_IMAGE_HPP
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cstdint>
+
+struct PgmImage {
+    uint32_t width;
+    uint32_t height;
+    uint32_t maxval;
+    std::vector<uint8_t> pixels;
+
+    PgmImage() : width(0), height(0), maxval(0) {}
+};
+
+bool readPgm(const std::string& filename, PgmImage& image);
+bool writePgm(const std::string& filename, const PgmImage& image);
+bool writePgm(std::ostream& out, const PgmImage& image);
+
+#endif
@@ -0,0 +1,28 @@
+#include "scratch_arena.hpp"
+
+ScratchArena::ScratchArena() : used_words(0), overflow_words(0) {}
+
+void ScratchArena::reset() {
+    if (!overflow.empty()) {
+        size_t high_water = used_words + overflow_words;
+        overflow.clear();
+        if (high_water > block.size()) {
+            block.assign(high_water, 0);
+        }
+    }
+    used_words = 0;
+    overflow_words = 0;
+}
+
+void* ScratchArena::allocate(size_t bytes) {
+    size_t words = (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    if (words == 0) words = 1;
+    if (used_words + words <= block.size()) {
+        void* p = &block[used_words];
+        used_words += words;
+        return p;
+    }
+    overflow.push_back(std::vector<uint64_t>(words));
+    overflow_words += words;
+    return overflow.back().data();
+}
@@ -0,0 +1,30 @@
+#ifndef SCRATCH_ARENA_HPP
+#define SCRATCH_ARENA_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Bump allocator for per-call scratch space. Memory handed out is valid until
+// the next reset(). Requests that do not fit spill into temporary chunks; the
+// following reset() folds the high-water mark into one block, so repeated
+// calls of the same shape stop touching the heap after the first one.
+class ScratchArena {
+private:
+    std::vector<uint64_t> block;
+    size_t used_words;
+    size_t overflow_words;
+    std::vector<std::vector<uint64_t> > overflow;
+
+public:
+    ScratchArena();
+    void reset();
+    void* allocate(size_t bytes);
+
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T)));
+    }
+};
+
+#endif
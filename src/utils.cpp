@@ -1,5 +1,8 @@
 #include "utils.hpp"
 #include <fstream>
+#include <sstream>
+#include <cmath>
+#include <limits>
 
 std::streamsize getFileSize(const std::string& filename) {
     std::ifstream file(filename, std::ios::binary | std::ios::ate);
@@ -16,4 +19,39 @@ double calculateCompressionRatio(std::streamsize original_size, std::streamsize
         return 0.0;
     }
     return static_cast<double>(original_size) / compressed_size;
-}
\ No newline at end of file
+}
+
+double calculatePSNR(double mean_squared_error, uint32_t maxval) {
+    if (mean_squared_error <= 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return 10.0 * std::log10((double)maxval * maxval / mean_squared_error);
+}
+
+bool readStreamContents(std::istream& in, std::string& contents) {
+    std::ostringstream buffer;
+    if (in.peek() != std::char_traits<char>::eof()) {
+        buffer << in.rdbuf();
+    }
+    in.clear();
+    contents = buffer.str();
+    return !in.bad();
+}
+
+bool readFileContents(const std::string& filename, std::string& contents) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    return readStreamContents(file, contents);
+}
+
+bool writeFileContents(const std::string& filename, const std::string& contents) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(contents.data(), contents.size());
+    file.close();
+    return static_cast<bool>(file);
+}
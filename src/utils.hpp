@@ -3,8 +3,13 @@
 
 #include <string>
 #include <iostream>
+#include <cstdint>
 
 std::streamsize getFileSize(const std::string& filename);
 double calculateCompressionRatio(std::streamsize original_size, std::streamsize compressed_size);
+double calculatePSNR(double mean_squared_error, uint32_t maxval);
+bool readStreamContents(std::istream& in, std::string& contents);
+bool readFileContents(const std::string& filename, std::string& contents);
+bool writeFileContents(const std::string& filename, const std::string& contents);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,111 @@
+// Fails when a warmed-up coder context touches the heap while coding a file.
+#include "test_support.hpp"
+#include "utils.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+static bool counting = false;
+static size_t allocation_count = 0;
+
+void* operator new(size_t size) {
+    if (counting) allocation_count++;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+static bool roundTrip(ArithmeticEncoder& encoder, ArithmeticDecoder& decoder,
+                      const std::string& input, bool adaptive) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(input.data());
+    bool ok = adaptive ? encoder.encodeAdaptiveBuffer(data, input.size())
+                       : encoder.encodeBuffer(data, input.size());
+    if (!ok) return false;
+
+    const std::vector<uint8_t>& codestream = encoder.getOutput();
+    ok = adaptive ? decoder.decodeAdaptiveBuffer(codestream.data(), codestream.size())
+                  : decoder.decodeBuffer(codestream.data(), codestream.size());
+    const std::vector<uint8_t>& decoded = decoder.getOutput();
+    return ok && decoded.size() == input.size() &&
+           std::memcmp(decoded.data(), input.data(), input.size()) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <repository_root>" << std::endl;
+        return 1;
+    }
+    const std::string root = argv[1];
+
+    std::vector<std::string> inputs;
+    const char* images[] = {"lena_ascii", "baboon_ascii", "quadrado_ascii"};
+    for (const char* name : images) {
+        std::string contents;
+        CHECK(readFileContents(root + "/input/" + name + ".pgm", contents));
+        inputs.push_back(contents);
+    }
+    // Typical small-file sizes for the high-rate workloads.
+    const size_t slice_sizes[] = {10 * 1024, 30 * 1024, 50 * 1024};
+    for (size_t size : slice_sizes) {
+        inputs.push_back(inputs[0].substr(0, size < inputs[0].size() ? size : inputs[0].size()));
+    }
+
+    // A cold context must allocate; otherwise the counting hook is not installed.
+    {
+        allocation_count = 0;
+        counting = true;
+        ArithmeticEncoder cold_encoder;
+        ArithmeticDecoder cold_decoder;
+        bool ok = roundTrip(cold_encoder, cold_decoder, inputs[0], false);
+        counting = false;
+        CHECK(ok);
+        CHECK(allocation_count > 0);
+    }
+
+    ArithmeticEncoder encoder;
+    ArithmeticDecoder decoder;
+    for (int adaptive = 0; adaptive < 2; ++adaptive) {
+        // Warm-up sizes the buffers and the scratch arena for the largest input.
+        for (int pass = 0; pass < 2; ++pass) {
+            for (const std::string& input : inputs) {
+                CHECK(roundTrip(encoder, decoder, input, adaptive != 0));
+            }
+        }
+
+        for (const std::string& input : inputs) {
+            allocation_count = 0;
+            counting = true;
+            bool ok = roundTrip(encoder, decoder, input, adaptive != 0);
+            counting = false;
+            CHECK(ok);
+            if (allocation_count != 0) {
+                std::cerr << (adaptive ? "adaptive" : "static") << " coding of " << input.size()
+                          << " bytes made " << allocation_count << " heap allocations" << std::endl;
+            }
+            CHECK(allocation_count == 0);
+        }
+    }
+
+    return testResult("steady_state_allocations");
+}
@@ -0,0 +1,37 @@
+// Decodes the checked-in results/*.codestream files and re-encodes input/*.pgm,
+// requiring byte-exact agreement in both directions.
+#include "test_support.hpp"
+#include "utils.hpp"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <repository_root>" << std::endl;
+        return 1;
+    }
+    const std::string root = argv[1];
+    const char* images[] = {"lena_ascii", "baboon_ascii", "quadrado_ascii"};
+
+    for (const char* image : images) {
+        std::string original, codestream, reconstructed;
+        CHECK(readFileContents(root + "/input/" + image + ".pgm", original));
+        CHECK(readFileContents(root + "/results/" + image + ".codestream", codestream));
+        CHECK(readFileContents(root + "/results/" + image + "-rec.pgm", reconstructed));
+        CHECK(!original.empty() && !codestream.empty());
+
+        std::string decoded;
+        CHECK(decodeLegacy(codestream, decoded));
+        CHECK(decoded == original);
+        CHECK(decoded == reconstructed);
+
+        std::string encoded;
+        CHECK(encodeLegacy(original, encoded));
+        CHECK(encoded == codestream);
+
+        // Level 4-6 payloads are the untagged format behind a 5-byte tag.
+        std::string tagged;
+        CHECK(encodeLevel(original, 5, tagged));
+        CHECK(tagged.size() == codestream.size() + 5 && tagged.compare(5, std::string::npos, codestream) == 0);
+    }
+
+    return testResult("golden_codestreams");
+}
@@ -0,0 +1,230 @@
+// Round-trips edge-case and fuzzed inputs through every engine, checks the
+// MAX_FREQ_SUM model boundary, and feeds truncated codestreams to the decoders.
+#include "test_support.hpp"
+#include "constants.hpp"
+#include "near_lossless.hpp"
+#include "pgm_image.hpp"
+#include <random>
+#include <fstream>
+#include <map>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+static std::string fuzzInput(uint32_t seed) {
+    std::mt19937 rng(seed);
+    const size_t lengths[] = {1, 2, 3, 31, 255, 4096, 65537};
+    const int alphabets[] = {1, 2, 3, 17, 256};
+    size_t length = lengths[rng() % 7];
+    int alphabet = alphabets[rng() % 5];
+
+    std::string data(length, '\0');
+    for (size_t i = 0; i < length; ++i) {
+        // Skew half the samples onto the first symbol so tables are uneven.
+        data[i] = static_cast<char>((rng() & 1) ? 0 : rng() % alphabet);
+    }
+    return data;
+}
+
+static void checkAllEngines(const std::string& input) {
+    std::string codestream, decoded;
+    CHECK(encodeLegacy(input, codestream));
+    CHECK(decodeLegacy(codestream, decoded));
+    CHECK(decoded == input);
+
+    for (int level : ENGINE_LEVELS) {
+        decoded.clear();
+        CHECK(encodeLevel(input, level, codestream));
+        CHECK(decodeLevel(codestream, decoded));
+        CHECK(decoded == input);
+    }
+
+    if (input.empty()) return;
+    std::map<unsigned char, uint32_t> model;
+    for (unsigned char c : input) model[c]++;
+    std::istringstream in(input);
+    std::ostringstream coded;
+    ArithmeticEncoder encoder;
+    CHECK(encoder.encodeWithModel(in, coded, model));
+    std::istringstream coded_in(coded.str());
+    std::ostringstream out;
+    ArithmeticDecoder decoder;
+    CHECK(decoder.decodeWithModel(coded_in, out, input.size(), model));
+    CHECK(out.str() == input);
+}
+
+static void checkFrequencySumBoundary() {
+    // A model summing to exactly MAX_FREQ_SUM with two frequency-1 symbols is
+    // the narrowest interval the coder must still resolve.
+    std::map<unsigned char, uint32_t> model;
+    model['a'] = 1;
+    model['b'] = (uint32_t)(MAX_FREQ_SUM - 2);
+    model['c'] = 1;
+    std::string input = "bbbbabbbbbbcbbbbbbbbbbbbbbbbbbbbbbbacabbbbbbbbbbbbc";
+
+    std::istringstream in(input);
+    std::ostringstream coded;
+    ArithmeticEncoder encoder;
+    CHECK(encoder.encodeWithModel(in, coded, model));
+    std::istringstream coded_in(coded.str());
+    std::ostringstream out;
+    ArithmeticDecoder decoder;
+    CHECK(decoder.decodeWithModel(coded_in, out, input.size(), model));
+    CHECK(out.str() == input);
+
+    model['b']++;
+    std::istringstream over_in(input);
+    std::ostringstream over_coded;
+    CHECK(!encoder.encodeWithModel(over_in, over_coded, model));
+    std::istringstream empty_in;
+    std::ostringstream empty_out;
+    CHECK(!decoder.decodeWithModel(empty_in, empty_out, input.size(), model));
+
+    // Untagged header claiming one more byte than the coder supports.
+    uint64_t total = MAX_FREQ_SUM + 1;
+    uint32_t num_symbols = 1;
+    unsigned char symbol = 'x';
+    uint32_t freq = (uint32_t)total;
+    std::string header;
+    header.append(reinterpret_cast<const char*>(&total), sizeof(total));
+    header.append(reinterpret_cast<const char*>(&num_symbols), sizeof(num_symbols));
+    header.append(reinterpret_cast<const char*>(&symbol), sizeof(symbol));
+    header.append(reinterpret_cast<const char*>(&freq), sizeof(freq));
+    header.append(16, '\0');
+    std::string decoded;
+    CHECK(!decodeLegacy(header, decoded));
+
+    // Byte count that disagrees with the frequency table is a corrupt header.
+    std::string codestream;
+    CHECK(encodeLegacy("abcabc", codestream));
+    uint64_t wrong_total = 7;
+    codestream.replace(0, sizeof(wrong_total), reinterpret_cast<const char*>(&wrong_total), sizeof(wrong_total));
+    CHECK(!decodeLegacy(codestream, decoded));
+}
+
+static void checkTruncatedStreams(const std::string& input) {
+    std::string codestream, decoded;
+    CHECK(encodeLegacy(input, codestream));
+    for (size_t cut = 0; cut < 12 && cut < codestream.size(); ++cut) {
+        CHECK(!decodeLegacy(codestream.substr(0, cut), decoded));
+    }
+    for (int level : ENGINE_LEVELS) {
+        CHECK(encodeLevel(input, level, codestream));
+        for (size_t cut = 0; cut < codestream.size(); cut += 1 + codestream.size() / 16) {
+            decoded.clear();
+            bool ok = decodeLevel(codestream.substr(0, cut), decoded);
+            CHECK(!ok || decoded != input);
+        }
+    }
+}
+
+static void checkCorruptAdaptiveCount(const std::string& input) {
+    // The level 7-9 payload starts with an 8-byte symbol count; a huge one
+    // must be rejected before the decoder starts producing output.
+    std::string codestream, decoded;
+    CHECK(encodeLevel(input, MAX_COMPRESSION_LEVEL, codestream));
+    uint64_t count = (uint64_t)1 << 40;
+    codestream.replace(sizeof(LEVEL_MAGIC) + 1, sizeof(count), reinterpret_cast<const char*>(&count), sizeof(count));
+    CHECK(!decodeLevel(codestream, decoded));
+
+    count = MAX_FREQ_SUM + 1;
+    codestream.replace(sizeof(LEVEL_MAGIC) + 1, sizeof(count), reinterpret_cast<const char*>(&count), sizeof(count));
+    CHECK(!decodeLevel(codestream, decoded));
+}
+
+// Every level encodes and keeps its own tag, but shares its tier's engine.
+static void checkLevelTags(const std::string& input) {
+    for (int level = MIN_COMPRESSION_LEVEL; level <= MAX_COMPRESSION_LEVEL; ++level) {
+        std::string codestream, tier_codestream, decoded;
+        int tier_level = level;
+        for (int engine_level : ENGINE_LEVELS) {
+            if (getLevelEngine(engine_level) == getLevelEngine(level)) tier_level = engine_level;
+        }
+        CHECK(encodeLevel(input, level, codestream));
+        CHECK(encodeLevel(input, tier_level, tier_codestream));
+        CHECK(codestream.size() > sizeof(LEVEL_MAGIC));
+        if (codestream.size() <= sizeof(LEVEL_MAGIC)) continue;
+        CHECK(codestream[sizeof(LEVEL_MAGIC)] == static_cast<char>(level));
+        tier_codestream[sizeof(LEVEL_MAGIC)] = static_cast<char>(level);
+        CHECK(codestream == tier_codestream);
+        CHECK(decodeLevel(codestream, decoded));
+        CHECK(decoded == input);
+    }
+    std::string codestream;
+    CHECK(!encodeLevel(input, MIN_COMPRESSION_LEVEL - 1, codestream));
+    CHECK(!encodeLevel(input, MAX_COMPRESSION_LEVEL + 1, codestream));
+}
+
+static void checkNearLossless() {
+    PgmImage image;
+    image.width = 37;
+    image.height = 23;
+    image.maxval = 255;
+    std::mt19937 rng(7);
+    for (uint32_t y = 0; y < image.height; ++y) {
+        for (uint32_t x = 0; x < image.width; ++x) {
+            image.pixels.push_back(static_cast<uint8_t>((x * 7 + y * 3 + rng() % 9) & 0xFF));
+        }
+    }
+    CHECK(writePgm("roundtrip_nl.pgm", image));
+
+    for (uint32_t max_error = 0; max_error <= 3; ++max_error) {
+        NearLosslessEncoder encoder;
+        NearLosslessDecoder decoder;
+        PgmImage decoded;
+        CHECK(encoder.encode("roundtrip_nl.pgm", "roundtrip_nl.codestream", max_error));
+        CHECK(decoder.decode("roundtrip_nl.codestream", "roundtrip_nl-rec.pgm"));
+        CHECK(readPgm("roundtrip_nl-rec.pgm", decoded));
+        CHECK(decoded.pixels.size() == image.pixels.size());
+
+        uint32_t worst = 0;
+        for (size_t i = 0; i < image.pixels.size() && i < decoded.pixels.size(); ++i) {
+            uint32_t error = (uint32_t)std::abs((int)image.pixels[i] - (int)decoded.pixels[i]);
+            if (error > worst) worst = error;
+        }
+        CHECK(worst <= max_error);
+        CHECK(worst == encoder.getMaxError());
+    }
+    std::remove("roundtrip_nl.pgm");
+    std::remove("roundtrip_nl.codestream");
+    std::remove("roundtrip_nl-rec.pgm");
+
+    // Dimensions far beyond the file contents must fail, not allocate them.
+    const char* oversized[] = {"P2\n4000000000 4000000000\n255\n1 2 3\n",
+                               "P5\n4000000000 4000000000\n255\nabc"};
+    for (const char* header : oversized) {
+        {
+            std::ofstream file("roundtrip_oversized.pgm", std::ios::binary);
+            file << header;
+        }
+        PgmImage oversized_image;
+        CHECK(!readPgm("roundtrip_oversized.pgm", oversized_image));
+    }
+    std::remove("roundtrip_oversized.pgm");
+}
+
+int main() {
+    std::vector<std::string> inputs;
+    inputs.push_back("");
+    inputs.push_back("a");
+    inputs.push_back(std::string(10000, 'a'));
+    inputs.push_back("ab");
+    std::string all_bytes;
+    for (int b = 0; b < 256; ++b) all_bytes.push_back(static_cast<char>(b));
+    inputs.push_back(all_bytes);
+    inputs.push_back(all_bytes + all_bytes + std::string(5000, '\xff'));
+    for (uint32_t seed = 1; seed <= 40; ++seed) {
+        inputs.push_back(fuzzInput(seed));
+    }
+
+    for (const auto& input : inputs) {
+        checkAllEngines(input);
+    }
+    checkFrequencySumBoundary();
+    checkTruncatedStreams(fuzzInput(3) + all_bytes);
+    checkLevelTags(fuzzInput(5));
+    checkCorruptAdaptiveCount(fuzzInput(6));
+    checkNearLossless();
+
+    return testResult("roundtrip_edge_cases");
+}
@@ -0,0 +1,65 @@
+#ifndef TEST_SUPPORT_HPP
+#define TEST_SUPPORT_HPP
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "arithmetic_coder.hpp"
+#include "level_codec.hpp"
+
+static int test_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond << std::endl; \
+            ++test_failures; \
+        } \
+    } while (0)
+
+inline bool encodeLegacy(const std::string& input, std::string& codestream) {
+    std::istringstream in(input);
+    std::ostringstream out;
+    ArithmeticEncoder encoder;
+    bool ok = encoder.encodeStream(in, out);
+    codestream = out.str();
+    return ok;
+}
+
+inline bool decodeLegacy(const std::string& codestream, std::string& output) {
+    std::istringstream in(codestream);
+    std::ostringstream out;
+    ArithmeticDecoder decoder;
+    bool ok = decoder.decodeStream(in, out);
+    output = out.str();
+    return ok;
+}
+
+inline bool encodeLevel(const std::string& input, int level, std::string& codestream) {
+    std::istringstream in(input);
+    std::ostringstream out;
+    LevelEncoder encoder;
+    bool ok = encoder.encodeStream(in, out, level);
+    codestream = out.str();
+    return ok;
+}
+
+inline bool decodeLevel(const std::string& codestream, std::string& output) {
+    std::istringstream in(codestream);
+    std::ostringstream out;
+    LevelDecoder decoder;
+    bool ok = decoder.decodeStream(in, out);
+    output = out.str();
+    return ok;
+}
+
+inline int testResult(const char* name) {
+    if (test_failures == 0) {
+        std::cout << name << ": all checks passed" << std::endl;
+        return 0;
+    }
+    std::cerr << name << ": " << test_failures << " check(s) failed" << std::endl;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,77 @@
+// Fails when decode throughput of any engine drops more than the stored
+// tolerance below its measured baseline.
+#include "test_support.hpp"
+#include "utils.hpp"
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <iomanip>
+
+static double bestDecodeSpeed(const std::string& codestream, bool tagged, const std::string& expected) {
+    const int runs = 5;
+    double best = 0.0;
+    for (int run = 0; run < runs; ++run) {
+        std::string decoded;
+        auto start_time = std::chrono::high_resolution_clock::now();
+        bool ok = tagged ? decodeLevel(codestream, decoded) : decodeLegacy(codestream, decoded);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        CHECK(ok && decoded == expected);
+
+        double seconds = std::chrono::duration<double>(end_time - start_time).count();
+        double speed = expected.size() / 1e6 / (seconds > 0.0 ? seconds : 1e-9);
+        if (speed > best) best = speed;
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <repository_root> <baseline_file>" << std::endl;
+        return 1;
+    }
+    const std::string root = argv[1];
+
+    std::map<std::string, double> baseline;
+    double tolerance = 0.0;
+    std::ifstream baseline_file(argv[2]);
+    CHECK(baseline_file.is_open());
+    std::string line;
+    while (std::getline(baseline_file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string engine;
+        double value;
+        if (!(fields >> engine >> value)) continue;
+        if (engine == "tolerance") {
+            tolerance = value;
+        } else {
+            baseline[engine] = value;
+        }
+    }
+
+    std::string original, golden;
+    CHECK(readFileContents(root + "/input/lena_ascii.pgm", original));
+    CHECK(readFileContents(root + "/results/lena_ascii.codestream", golden));
+
+    std::map<std::string, double> measured;
+    measured["arith-o0"] = bestDecodeSpeed(golden, false, original);
+    const int tagged_levels[] = {1, 9};
+    for (int level : tagged_levels) {
+        std::string codestream;
+        CHECK(encodeLevel(original, level, codestream));
+        measured[getLevelEngineName(level)] = bestDecodeSpeed(codestream, true, original);
+    }
+
+    for (const auto& pair : baseline) {
+        auto it = measured.find(pair.first);
+        CHECK(it != measured.end());
+        if (it == measured.end()) continue;
+        double floor_speed = pair.second * (1.0 - tolerance);
+        std::cout << std::left << std::setw(10) << pair.first << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(9) << it->second << " MB/s (baseline " << pair.second
+                  << ", floor " << floor_speed << ")" << std::endl;
+        CHECK(it->second >= floor_speed);
+    }
+
+    return testResult("decode_throughput");
+}